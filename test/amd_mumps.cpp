@@ -26,7 +26,9 @@
 //
 // Purpose: Read a matrix market in coordinate format to solve by MUMPS
 //
-// Usage : mpirun -np X "executable" --mtx <mtx input file> --perf_mode <enable_perf_mode> --iter <no_of_performance_iterations>
+// Usage : mpirun -np X "executable" --mtx <mtx, hb or rb input file, optionally .gz/.xz> --perf_mode <enable_perf_mode> --iter <no_of_performance_iterations>
+//                                   [--wk_user <0|1>] [--hugepages <none|thp|explicit>] [--numa <none|local|interleave>]
+//                                   [--regime <hot|cold|process>] [--flush_mb <llc_flush_buffer_MB>] [--input_numa <none|local|interleave>]
 // Standard C++ includes
 //
 #ifdef MUMPS_MPI
@@ -35,14 +37,23 @@
 #include <omp.h>
 #include "cblas.hh"
 #include "dmumps_c.h"
+#ifdef AMD_MUMPS_HAVE_ZMUMPS
+#include "zmumps_c.h"
+#endif
+#include "amd_mumps_workspace.h"
+#include "amd_mumps_perf.h"
+#include "amd_mumps_reader.h"
 #include <math.h>
 #include <cstdlib>
+#include <algorithm>
 #include <iomanip>
 #include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include <boost/algorithm/string.hpp>
 
@@ -66,6 +77,7 @@ using namespace std;
 
 /*
     structure to store matrix data from mtx file in co-ordinate storage format
+    complex values are stored as interleaved (real, imaginary) pairs
 */
 template<typename ILP_INT, typename T>
 struct _coo_matrix {
@@ -75,39 +87,117 @@ struct _coo_matrix {
     std::vector<ILP_INT> row_idxs;
     std::vector<ILP_INT> col_idxs;
     std::vector<double> values;
+    bool is_complex = false;
+    amd_mumps::matrix_symmetry symmetry = amd_mumps::matrix_symmetry::general;
 };
 typedef struct _coo_matrix<MUMPS_INT, double> coo_matrix;
 
+/*
+    arithmetic specific entry points, selected from the input matrix field
+*/
+template<typename STRUC>
+struct mumps_traits;
+
+template<>
+struct mumps_traits<DMUMPS_STRUC_C> {
+    typedef double scalar;
+    static void call(DMUMPS_STRUC_C* id) { dmumps_c(id); }
+    static double dist2_one(double v) { return (v - 1.0) * (v - 1.0); }
+};
+
+#ifdef AMD_MUMPS_HAVE_ZMUMPS
+template<>
+struct mumps_traits<ZMUMPS_STRUC_C> {
+    typedef ZMUMPS_COMPLEX scalar;
+    static void call(ZMUMPS_STRUC_C* id) { zmumps_c(id); }
+    static double dist2_one(const ZMUMPS_COMPLEX& v) { return (v.r - 1.0) * (v.r - 1.0) + v.i * v.i; }
+};
+#endif
+
+/*
+    command line options
+*/
+struct bench_args {
+    std::string matrix_name;
+    bool enable_perf_mode = false;
+    int number_hot_calls = 1;
+    bool use_wk_user = false;
+    amd_mumps::page_policy wk_pages = amd_mumps::page_policy::thp;
+    amd_mumps::numa_policy wk_numa = amd_mumps::numa_policy::local;
+    amd_mumps::bench_regime regime = amd_mumps::bench_regime::hot;
+    std::size_t flush_mb = 0;
+    bool place_input = false;
+    amd_mumps::numa_policy input_numa = amd_mumps::numa_policy::none;
+    bool spd = true;
+};
+
+/*
+    per call measurements of one MUMPS phase (JOB=1/2/3)
+*/
+struct phase_stats {
+    std::vector<double> seconds;
+    std::vector<amd_mumps::hw_sample> hw;
+    amd_mumps::page_faults faults; // mean per call
+
+    std::chrono::duration<double, std::nano> mean_time() const
+    {
+        double t = 0.0;
+        for (double s : seconds)
+            t += s;
+        return std::chrono::duration<double, std::nano>(seconds.empty() ? 0.0 : 1.0e9 * t / seconds.size());
+    }
+    double min_seconds() const { return seconds.empty() ? 0.0 : *std::min_element(seconds.begin(), seconds.end()); }
+    double max_seconds() const { return seconds.empty() ? 0.0 : *std::max_element(seconds.begin(), seconds.end()); }
+    amd_mumps::hw_sample mean_hw() const
+    {
+        amd_mumps::hw_sample m;
+        for (const auto& h : hw)
+            m += h;
+        if (!hw.empty()) {
+            m.cycles /= hw.size();
+            m.llc_misses /= hw.size();
+        }
+        return m;
+    }
+};
+
 /*
     usage function
 */
 void print_help(char* mumps_bench)
 {
     cout << "\nUsage: " << mumps_bench << " --mtx <mtx_input_file> --perf_mode <enable_perf_mode> --iter <no_of_performance_iterations>\n";
-    cout << "\tmtx_input_file: input matrix in Matrix Market Format\n";    
+    cout << "\tmtx_input_file: input matrix in Matrix Market, Harwell-Boeing or Rutherford-Boeing format, plain or gzip/xz compressed\n";    
     cout << "\tenable_perf_mode: 0 = for functional tests, >1 = perf runs)\n";
     cout << "\tno_of_performance_iterations: number of hot calls for performance runs\n";    
+    cout << "\t--wk_user: 1 = provide a reusable factorization workspace through WK_USER (default 0)\n";
+    cout << "\t--hugepages: page backing of the WK_USER workspace: none, thp (default), explicit\n";
+    cout << "\t--numa: NUMA placement of the WK_USER workspace: none, local (default), interleave\n";
+    cout << "\t--regime: measurement regime of perf runs: hot (default), cold = LLC flushed before every call, process = first call of a fresh process, LLC flushed before it\n";
+    cout << "\t--flush_mb: size of the LLC flush buffer in MB for the cold regime (default 0 = 8x LLC, at least 256)\n";
+    cout << "\t--input_numa: placement of the input matrix and rhs on the host: none (default), local = first touch on the rank's node, interleave\n";
+    cout << "\t--spd: 1 = factorize real symmetric input as positive definite (SYM=1, default); 0 = general symmetric (SYM=2), for indefinite matrices\n";
     return;
 }
 /*
-    =======main=========
+    analysis, factorization and solution of the matrix with the MUMPS
+    arithmetic given by STRUC, followed by the statistics report
 */
-int main(int argc, char* argv[]) 
+template<typename STRUC>
+int run_benchmark(const bench_args& args, coo_matrix& matrix, int myid, int comm_size, amd_mumps::hw_counters& counters)
 {
-    //mpi variables
-    int myid, ierr;
-    int comm_size;
-
-#ifdef MUMPS_MPI
-    ierr = MPI_Init(&argc, &argv);
-    ierr = MPI_Comm_rank(MPI_COMM_WORLD, &myid);
-    ierr = MPI_Comm_size(MPI_COMM_WORLD, &comm_size);        
-#endif 
-
-    // args
-    string matrix_name;
-    bool enable_perf_mode = false;
-    int number_hot_calls = 1;
+    typedef typename mumps_traits<STRUC>::scalar T;
+    auto mumps_c = &mumps_traits<STRUC>::call;
+
+    const bool enable_perf_mode = args.enable_perf_mode;
+    const int number_hot_calls = args.number_hot_calls;
+    const bool use_wk_user = args.use_wk_user;
+    const amd_mumps::page_policy wk_pages = args.wk_pages;
+    const amd_mumps::numa_policy wk_numa = args.wk_numa;
+    const amd_mumps::bench_regime regime = args.regime;
+    const std::size_t flush_mb = args.flush_mb;
+    const bool place_input = args.place_input;
+    const amd_mumps::numa_policy input_numa = args.input_numa;
 
     // data     
         /*
@@ -115,174 +205,16 @@ int main(int argc, char* argv[])
         * SYM = 1: A is SPD
         * SYM = 2: A is general symmetric
         */    
-    int symVal = 1;
-    coo_matrix matrix;
-    DMUMPS_STRUC_C id;
-    MUMPS_INT nnz, i, nrhs;
-    MUMPS_INT m, n;
-    MUMPS_INT rid, cid;
-    std::vector<double> rhs, x;    
-    double value, relativeError = 0;
-
-    // file reading
-    std::string fileline;
-    int cnt = 0;
-    bool are_dimensions_read = false;
-    std::string ignore;
-    std::string matrix_format;
-    std::string arithmetic_field;
-    std::string symmetry_structure;    
-    if (argc < 7) 
-    {
-        print_help(argv[0]);
-        return 1;
-    } 
-
-    // read arguments
-    for (int i = 1; i < argc; i+=2) 
-    {
-        if (strcmp(argv[i], "--mtx") == 0) 
-        {
-            matrix_name = argv[i+1];
-        } else if (strcmp(argv[i], "--perf_mode") == 0) 
-        {
-            enable_perf_mode = std::stoi(argv[i+1]) > 0;
-        } else if (strcmp(argv[i], "--iter") == 0) 
-        {
-            number_hot_calls = (std::max)(1, std::stoi(argv[i+1]));
-        } else 
-        {
-            cout << "Invalid option " << argv[i] << endl;
-            print_help(argv[0]);
-            return 1;
-        }
-    }
-
-    nrhs = 1;
-    //   Create the ifstream reader  
-    std::ifstream mmfile(matrix_name);
-    if (!mmfile) {
-        std::cerr << "Failed to open file " << matrix_name << std::endl;
-        return 1;
-    }
-    
-    // -----------------------------------------
-    //   Read the matrix
-    // -----------------------------------------
-    
-    while (getline(mmfile, fileline)) 
-    {
-        if(fileline.empty() || (fileline[0] == '%' && fileline[1] != '%')) 
-        {           
-            //comment ignore
-            continue;
-        }
-        else if(fileline.empty() || (fileline[0] == '%' && fileline[1] == '%')) 
-        {
-            //header banner
-            std::stringstream ss;
-            ss << fileline;
-            ss >> ignore;
-            ss >> ignore;
-
-            ss >> matrix_format;
-            ss >> arithmetic_field;
-            ss >> symmetry_structure; 
-
-            //banner validation checks
-            if (matrix_format != "coordinate" && matrix_format != "array") {
-                std::cerr << "Invalid Matrix format in the header banner: " << matrix_format << std::endl;
-                exit(1);
-            }
-            if (arithmetic_field != "real" && arithmetic_field != "complex" && arithmetic_field != "integer" && arithmetic_field != "pattern") {
-                std::cerr << "Invalid arithmetic field in the header banner: " << arithmetic_field << std::endl;
-                exit(1);
-            }
-            //todo: to_lower() conversions to be done on 'symmetry_structure' before comparison to "skew-symmetric" and "hermitian" cases
-            if (symmetry_structure != "general" && symmetry_structure != "symmetric" && symmetry_structure != "skew-symmetric" && symmetry_structure != "hermitian") {
-                std::cerr << "Invalid symmetry structure in the header banner: " << symmetry_structure << std::endl;
-                exit(1);
-            }     
-
-            //unsupported cases
-            if (matrix_format != "coordinate") {
-                std::cerr << "array matrix format not supported" << std::endl;
-                exit(1);
-            }       
-            if (arithmetic_field != "real" && arithmetic_field != "integer") {
-                std::cerr << "complex/pattern fields not supported" << std::endl;
-                exit(1);
-            } 
-            if (symmetry_structure != "symmetric" && symmetry_structure != "general") {
-                std::cerr << "skew-symmetric and hermitian structures not supported" << std::endl;
-                exit(1);
-            }                              
-        }
-        else if(!are_dimensions_read)
-        {
-            //read dimensions
-            std::stringstream ss_dims;
-            ss_dims << fileline;
-            ss_dims >> m;
-            ss_dims >> n;
-            ss_dims >> nnz;
-            matrix.m = m;
-            matrix.n = n;
-            matrix.nnz = nnz;             
-
-            // Allocate arrays with the given dimensional data
-            try{
-                matrix.row_idxs.resize(nnz);
-            }
-            catch(std::bad_alloc &){
-                exit(1);
-            }
-            try{
-                matrix.col_idxs.resize(nnz);
-            }
-            catch(std::bad_alloc &){
-                exit(1);
-            } 
-            try{
-                matrix.values.resize(nnz);
-            }
-            catch(std::bad_alloc &){
-                exit(1);
-            } 
-            
-            are_dimensions_read = true;
-        }        
-        else if(are_dimensions_read)
-        {
-            //read data triplet
-            std::stringstream ss_data;
-            ss_data << fileline;
-            ss_data >> rid;
-            ss_data >> cid;   
-            ss_data >> value;         
-
-            //negative indices since row/col indices are not 1-based, which is expected in mtx/coo format
-            if(((rid - 1) < 0) || ((cid - 1) < 0))
-            {
-                exit(1);
-            }
-            matrix.row_idxs[cnt] = rid;
-            matrix.col_idxs[cnt] = cid;
-            matrix.values[cnt] = value;
-            cnt++;
-        }        
-    }    
-    mmfile.close();
+    // symmetric input keeps one triangle; skew-symmetric/complex hermitian are read as general.
+    // real symmetric input is factorized as SPD as before; --spd 0 selects LDLt with pivoting for indefinite archives
+    int symVal = matrix.symmetry == amd_mumps::matrix_symmetry::general ? 0 : (args.spd && !matrix.is_complex) ? 1 : 2;
+    STRUC id;
+    MUMPS_INT nnz = matrix.nnz, nrhs = 1;
+    MUMPS_INT m = matrix.m, n = matrix.n;
+    T* values = reinterpret_cast<T*>(matrix.values.data());
     // Allocate arrays and initialize RHS 
-    rhs.resize(nnz, 0.0); 
-    x.resize(nnz, 0.0); 
-
-    if(m != n)
-    {
-        std::cerr << "MUMPS requires a square sparse matrix that can be either unsymmetric, symmetric positive definite, or general symmetric"
-                  << std::endl;
-        return -1;
-    }
+    std::vector<T> rhs(nnz, T{}), x(nnz, T{});
+    double relativeError = 0;
 
     // ---------------------------------------------
     //   Setup the MUMPS Solver  
@@ -294,7 +226,7 @@ int main(int argc, char* argv[])
     id.sym = symVal;
     id.par = 1; /* The host is also involved in the parallel steps of the factorization and solve phases */
 
-    dmumps_c(&id);
+    mumps_c(&id);
     if (id.infog[0] < 0){
         std::cout << "[PROCESS: " << myid << "] Mumps Init phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
         return 1;
@@ -312,33 +244,118 @@ int main(int argc, char* argv[])
     id.ICNTL(23) = 250000; /* max size of the working memory (MB) that can allocate per processor: each processor will allocate workspace based on the estimates computed during the analysis*/    
     id.ICNTL(24) = 1; /* controls the detection of �null pivot rows�: Null pivot row detection*/  
 
+    // ---------------------------------------------
+    //   Input placement
+    // ---------------------------------------------
+    // copy the host arrays into pages first-touched on (or interleaved across)
+    // the NUMA nodes selected, instead of wherever the parser touched them
+    amd_mumps::workspace<MUMPS_INT> placed_irn(amd_mumps::page_policy::standard, input_numa);
+    amd_mumps::workspace<MUMPS_INT> placed_jcn(amd_mumps::page_policy::standard, input_numa);
+    amd_mumps::workspace<T> placed_a(amd_mumps::page_policy::standard, input_numa);
+    amd_mumps::workspace<T> placed_x(amd_mumps::page_policy::standard, input_numa);
+    T* rhs_data = x.data();
+    if (myid == 0 && place_input) {
+        if (!placed_irn.reserve(nnz) || !placed_jcn.reserve(nnz) || !placed_a.reserve(nnz) || !placed_x.reserve(x.size())) {
+            std::cout << "[PROCESS: " << myid << "] Failed to allocate placed input arrays\n";
+            return 1;
+        }
+        std::copy(matrix.row_idxs.begin(), matrix.row_idxs.end(), placed_irn.data());
+        std::copy(matrix.col_idxs.begin(), matrix.col_idxs.end(), placed_jcn.data());
+        std::copy(values, values + nnz, placed_a.data());
+        std::copy(x.begin(), x.end(), placed_x.data());
+        rhs_data = placed_x.data();
+    }
+
     /* Define the problem on the host */
     if (myid == 0) {
         id.n = n; 
         id.nz = nnz; 
-        id.irn = &matrix.row_idxs[0]; 
-        id.jcn = &matrix.col_idxs[0];
-        id.a = &matrix.values[0]; 
-        id.rhs = &x[0];
+        id.irn = place_input ? placed_irn.data() : &matrix.row_idxs[0]; 
+        id.jcn = place_input ? placed_jcn.data() : &matrix.col_idxs[0];
+        id.a = place_input ? placed_a.data() : values; 
+        id.rhs = rhs_data;
         id.nrhs = nrhs; 
         id.lrhs = n;
     }
+
+    // ---------------------------------------------
+    //   Measurement regime
+    // ---------------------------------------------
+    // Each call is timed individually; in the cold and process regimes the caches
+    // are swept before every call and the sweep is excluded from the timing. The
+    // process regime needs it too: the host has just parsed (and with --input_numa
+    // copied) the input, which would otherwise be cache resident for its first calls.
+    std::unique_ptr<amd_mumps::cache_flusher> flusher;
+    if (enable_perf_mode && regime != amd_mumps::bench_regime::hot)
+        flusher.reset(new amd_mumps::cache_flusher(flush_mb << 20));
+    auto run_phase = [&](int job, int calls, phase_stats& st)
+    {
+        st.seconds.clear();
+        st.hw.clear();
+        amd_mumps::page_faults pf0 = amd_mumps::read_page_faults();
+        for(int q=0; q<calls;q++)
+        {
+            if (flusher)
+                flusher->flush();
+            counters.start();
+            auto t0 = get_time::now();
+            id.job = job;
+            mumps_c(&id);
+            std::chrono::duration<double> elapsed = get_time::now() - t0;
+            st.hw.push_back(counters.stop());
+            st.seconds.push_back(elapsed.count());
+        }
+        amd_mumps::page_faults pf1 = amd_mumps::read_page_faults();
+        st.faults.minor = (pf1.minor - pf0.minor)/calls;
+        st.faults.major = (pf1.major - pf0.major)/calls;
+    };
+    phase_stats analysis_stats, factorization_stats, factorization_internal_stats, solution_stats;
     
     // ---------------------------------------------
     //   Analysis: Preprocessing and Symbolic Factorization
     // ---------------------------------------------     
-    id.job = 1; /* performs the analysis */
-    dmumps_c(&id);
+    run_phase(1, 1, analysis_stats); /* performs the analysis */
     if (id.infog[0] < 0){
         std::cout << "[PROCESS: " << myid << "] Mumps analysis phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
         return 1;
     }
 
+    // ---------------------------------------------
+    //   Factorization workspace (WK_USER)
+    // ---------------------------------------------
+    // Allocated once per rank from the analysis estimate and reused by every
+    // subsequent factorization; must outlive JOB=3 since the factors live in it.
+    amd_mumps::workspace<T> wk(wk_pages, wk_numa);
+    if (use_wk_user)
+    {
+        if (!wk.reserve(amd_mumps::factorization_workspace_entries(id))) {
+            std::cout << "[PROCESS: " << myid << "] Failed to allocate WK_USER workspace of " << amd_mumps::factorization_workspace_entries(id) << " entries\n";
+            return 1;
+        }
+        amd_mumps::attach_workspace(id, wk);
+    }
+
     // ---------------------------------------------
     //   Factorization
     // ---------------------------------------------
-    id.job = 2; /* performs the factorization */
-    dmumps_c(&id);
+    run_phase(2, 1, factorization_stats); /* performs the factorization */
+    // INFOG(1)=-9: workspace too small on some rank. JOB=2 is collective, so every
+    // rank retries; only the failing ranks (INFO(1)=-9) grow by their INFO(2)
+    // missing entries (millions if negative), the others see INFO(1)=-1.
+    for (int retry = 0; use_wk_user && id.infog[0] == -9 && retry < 3; retry++)
+    {
+        if (id.info[0] == -9) {
+            long long missing = id.info[1] < 0 ? -static_cast<long long>(id.info[1]) * 1000000LL : id.info[1];
+            if (wk.reserve(wk.size() + static_cast<std::size_t>(missing) + wk.size() / 10)) {
+                amd_mumps::attach_workspace(id, wk);
+            } else {
+                // cannot grow, let MUMPS allocate on this rank rather than leave the others waiting
+                std::cout << "[PROCESS: " << myid << "] Failed to grow WK_USER workspace, using the MUMPS internal workspace\n";
+                amd_mumps::detach_workspace(id);
+            }
+        }
+        run_phase(2, 1, factorization_stats); /* time the successful call, not the failed one */
+    }
     if (id.infog[0] < 0){
         std::cout << "[PROCESS: " << myid << "] Mumps factorization phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
         return 1;
@@ -347,8 +364,7 @@ int main(int argc, char* argv[])
     // ---------------------------------------------
     //   Solution
     // ---------------------------------------------
-    id.job = 3; /* computes the solution */
-    dmumps_c(&id);
+    run_phase(3, 1, solution_stats); /* computes the solution */
     if (id.infog[0] < 0){
         std::cout << "[PROCESS: " << myid << "] Mumps solution phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
         return 1;
@@ -357,10 +373,10 @@ int main(int argc, char* argv[])
     // ---------------------------------------------
     //  Configure Hot calls / Cold Calls
     // --------------------------------------------
-    std::fill(x.begin(), x.end(), 0.0); //reinitialize rhs
+    std::fill(rhs_data, rhs_data + x.size(), T{}); //reinitialize rhs
     const int number_cold_calls = 5;    
-    std::chrono::duration<double, std::nano> analysis_time, factorization_time, solution_time;
-    if(enable_perf_mode)
+    // process regime: the first calls above are the measurement, run once per fresh process
+    if(enable_perf_mode && regime != amd_mumps::bench_regime::process)
     {
         // ---------------------------------------------
         //  Performance Mode - Warmp up
@@ -368,81 +384,78 @@ int main(int argc, char* argv[])
         for(int q=0; q<number_cold_calls;q++)
         {    
             id.job = 1;     /* performs the analysis */
-            dmumps_c(&id);     
+            mumps_c(&id);     
         }
         for(int q=0; q<number_cold_calls;q++)
         {    
             id.job = 2;     /* performs the factorization */
-            dmumps_c(&id);     
+            mumps_c(&id);     
         }
         for(int q=0; q<number_cold_calls;q++)
         {    
             id.job = 3;     /* performs the solution */
-            dmumps_c(&id);     
+            mumps_c(&id);     
         }   
 
         // ---------------------------------------------
-        //  Performance Mode - Hot calls
+        //  Performance Mode - Timed calls
         // --------------------------------------------
-        std::fill(x.begin(), x.end(), 0.0); //reinitialize rhs
+        std::fill(rhs_data, rhs_data + x.size(), T{}); //reinitialize rhs
         // ---------------------------------------------
         //   Analysis
         // ---------------------------------------------  
-        auto t1 = get_time::now();
-        for(int q=0; q<number_hot_calls;q++)
-        {    
-            id.job = 1;     /* performs the analysis */
-            dmumps_c(&id);     
-        }
-        analysis_time = (get_time::now() - t1)/number_hot_calls;
+        run_phase(1, number_hot_calls, analysis_stats); /* performs the analysis */
 
         // ---------------------------------------------
         //   Factorization
         // ---------------------------------------------    
-        auto t2 = get_time::now();
-        for(int q=0; q<number_hot_calls;q++)
-        {    
-            id.job = 2; /* performs the factorization */    
-            dmumps_c(&id);     
+        if(use_wk_user)
+        {
+            // baseline: MUMPS internal workspace, reallocated on every JOB=2
+            amd_mumps::detach_workspace(id);
+            run_phase(2, number_hot_calls, factorization_internal_stats);
+            amd_mumps::attach_workspace(id, wk);
         }
-        factorization_time = (get_time::now() - t2)/number_hot_calls;
+        run_phase(2, number_hot_calls, factorization_stats); /* performs the factorization */
+
         // ---------------------------------------------
         //   Solution
         // ---------------------------------------------                
-        auto t3 = get_time::now();
-        for(int q=0; q<number_hot_calls;q++)
-        {    
-            id.job = 3; /* computes the solution */
-            dmumps_c(&id);     
-        }
-        solution_time = (get_time::now() - t3)/number_hot_calls;                        
+        run_phase(3, number_hot_calls, solution_stats); /* computes the solution */
     } 
+    std::chrono::duration<double, std::nano> analysis_time = analysis_stats.mean_time();
+    std::chrono::duration<double, std::nano> factorization_time = factorization_stats.mean_time();
+    std::chrono::duration<double, std::nano> solution_time = solution_stats.mean_time();
+    std::chrono::duration<double, std::nano> factorization_time_internal = factorization_internal_stats.mean_time();
+    amd_mumps::page_faults fact_faults = factorization_stats.faults;
+    amd_mumps::page_faults fact_faults_internal = factorization_internal_stats.faults;
+    if (place_input && myid == 0)
+        std::copy(rhs_data, rhs_data + x.size(), x.begin());
 
     // ---------------------------------------------
     //   Termination and release of memory.
     // ---------------------------------------------
     id.job = JOB_END; /* JOB = -2 : terminates an instance of the package */
-    dmumps_c(&id);
+    mumps_c(&id);
     if (id.infog[0] < 0){
         std::cout << "[PROCESS: " << myid << "] Mumps temination phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
         return 1;
     }
 
     //todo: relook at relative error computation
-    double numerator = 0.0;
-    for (int i = 1; i < n; i++)
+    // the solution is centralized on the host, the other ranks hold no matrix entries
+    if (myid == 0)
     {
-        numerator += pow((x[i] - 1.0), 2);
+        double numerator = 0.0;
+        for (int i = 1; i < n; i++)
+        {
+            numerator += mumps_traits<STRUC>::dist2_one(x[i]);
+        }
+        numerator = sqrt(numerator);
+        double denominator = sqrt(static_cast<double>(n));
+        relativeError = numerator / denominator;
     }
-    numerator = sqrt(numerator);
-    double denominator = sqrt(static_cast<double>(n));
-    relativeError = numerator / denominator;
    
-    // MPI terminate
-#ifdef MUMPS_MPI
-    ierr = MPI_Finalize();
-#endif
-
     // ---------------------------------------------
     //   Important statistics
     // ---------------------------------------------
@@ -476,6 +489,8 @@ int main(int argc, char* argv[])
                 << std::setw(16) << "afs_time" 
                 << std::setw(16) << "fs_time" 
                 << std::setw(12) << "relativeError" 
+                << std::setw(14) << "fact_minflt" 
+                << std::setw(14) << "fact_majflt" 
                 << std::endl;
 
         std::cout << std::setw(12) << m
@@ -489,9 +504,233 @@ int main(int argc, char* argv[])
                 << std::setw(16) << std::scientific << solve_t 
                 << std::setw(16) << std::scientific << afs_t 
                 << std::setw(16) << std::scientific << fs_t
-                << std::setw(12) << std::fixed << relativeError << std::endl;          
+                << std::setw(12) << std::fixed << relativeError
+                << std::setw(14) << fact_faults.minor
+                << std::setw(14) << fact_faults.major << std::endl;          
+
+        if (enable_perf_mode)
+        {
+            // mean per call; bandwidth estimated from LLC misses of 64 byte lines
+            std::cout << std::endl;
+            std::cout << std::setw(16) << "regime"
+                    << std::setw(16) << "phase"
+                    << std::setw(12) << "calls"
+                    << std::setw(16) << "mean_time"
+                    << std::setw(16) << "min_time"
+                    << std::setw(16) << "max_time"
+                    << std::setw(16) << "cycles"
+                    << std::setw(16) << "llc_misses"
+                    << std::setw(16) << "llc_miss_GBps"
+                    << std::endl;
+            const std::pair<const char*, const phase_stats*> phases[] = {
+                {"analysis", &analysis_stats}, {"factorization", &factorization_stats}, {"solution", &solution_stats}};
+            for (const auto& ph : phases)
+            {
+                amd_mumps::hw_sample hw = ph.second->mean_hw();
+                double t = std::chrono::duration_cast<ns>(ph.second->mean_time()).count() / 1.0e9;
+                std::cout << std::setw(16) << amd_mumps::regime_name(regime)
+                        << std::setw(16) << ph.first
+                        << std::setw(12) << ph.second->seconds.size()
+                        << std::setw(16) << std::scientific << t
+                        << std::setw(16) << std::scientific << ph.second->min_seconds()
+                        << std::setw(16) << std::scientific << ph.second->max_seconds();
+                if (counters.available())
+                    std::cout << std::setw(16) << hw.cycles
+                            << std::setw(16) << hw.llc_misses
+                            << std::setw(16) << std::fixed << (t > 0.0 ? 64.0 * hw.llc_misses / t / 1.0e9 : 0.0);
+                else
+                    std::cout << std::setw(16) << "n/a" << std::setw(16) << "n/a" << std::setw(16) << "n/a";
+                std::cout << std::endl;
+            }
+            if (flusher)
+                std::cout << "LLC flush buffer: " << std::fixed << flusher->bytes() / 1048576.0 << " MB" << std::endl;
+        }
+
+        if (use_wk_user && enable_perf_mode && regime != amd_mumps::bench_regime::process)
+        {
+            double factor_internal_t = std::chrono::duration_cast<ns>(factorization_time_internal).count() / 1.0e9;
+            std::cout << std::endl;
+            std::cout << std::setw(12) << "wk_user_MB"
+                    << std::setw(12) << "huge_pages"
+                    << std::setw(20) << "fact_time_internal"
+                    << std::setw(20) << "fact_time_wk_user"
+                    << std::setw(12) << "speedup"
+                    << std::setw(20) << "minflt_internal"
+                    << std::setw(20) << "minflt_wk_user"
+                    << std::setw(20) << "majflt_internal"
+                    << std::setw(20) << "majflt_wk_user"
+                    << std::endl;
+            std::cout << std::setw(12) << std::fixed << wk.bytes() / 1048576.0
+                    << std::setw(12) << std::to_string(wk.bytes() ? 100 * wk.huge_page_bytes() / wk.bytes() : 0) + "%"
+                    << std::setw(20) << std::scientific << factor_internal_t
+                    << std::setw(20) << std::scientific << factor_t
+                    << std::setw(12) << std::fixed << (factor_t > 0.0 ? factor_internal_t / factor_t : 0.0)
+                    << std::setw(20) << fact_faults_internal.minor
+                    << std::setw(20) << fact_faults.minor
+                    << std::setw(20) << fact_faults_internal.major
+                    << std::setw(20) << fact_faults.major
+                    << std::endl;
+        }
 
     }
 
     return 0;
 }
+
+/*
+    =======main=========
+*/
+int main(int argc, char* argv[]) 
+{
+    //mpi variables
+    int myid = 0, ierr;
+    int comm_size = 1;
+
+#ifdef MUMPS_MPI
+    ierr = MPI_Init(&argc, &argv);
+    ierr = MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    ierr = MPI_Comm_size(MPI_COMM_WORLD, &comm_size);        
+#endif 
+
+    // args
+    bench_args args;
+    coo_matrix matrix;
+
+    if (argc < 7) 
+    {
+        print_help(argv[0]);
+        return 1;
+    } 
+
+    // read arguments
+    for (int i = 1; i < argc; i+=2) 
+    {
+        if (strcmp(argv[i], "--mtx") == 0) 
+        {
+            args.matrix_name = argv[i+1];
+        } else if (strcmp(argv[i], "--perf_mode") == 0) 
+        {
+            args.enable_perf_mode = std::stoi(argv[i+1]) > 0;
+        } else if (strcmp(argv[i], "--iter") == 0) 
+        {
+            args.number_hot_calls = (std::max)(1, std::stoi(argv[i+1]));
+        } else if (strcmp(argv[i], "--wk_user") == 0) 
+        {
+            args.use_wk_user = std::stoi(argv[i+1]) > 0;
+        } else if (strcmp(argv[i], "--hugepages") == 0) 
+        {
+            if (!amd_mumps::parse_page_policy(argv[i+1], args.wk_pages)) {
+                cout << "Invalid hugepages policy " << argv[i+1] << endl;
+                print_help(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--numa") == 0) 
+        {
+            if (!amd_mumps::parse_numa_policy(argv[i+1], args.wk_numa)) {
+                cout << "Invalid numa policy " << argv[i+1] << endl;
+                print_help(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--regime") == 0) 
+        {
+            if (!amd_mumps::parse_bench_regime(argv[i+1], args.regime)) {
+                cout << "Invalid regime " << argv[i+1] << endl;
+                print_help(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--flush_mb") == 0) 
+        {
+            args.flush_mb = static_cast<std::size_t>((std::max)(0, std::stoi(argv[i+1])));
+        } else if (strcmp(argv[i], "--input_numa") == 0) 
+        {
+            if (!amd_mumps::parse_numa_policy(argv[i+1], args.input_numa)) {
+                cout << "Invalid input numa policy " << argv[i+1] << endl;
+                print_help(argv[0]);
+                return 1;
+            }
+            args.place_input = args.input_numa != amd_mumps::numa_policy::none;
+        } else if (strcmp(argv[i], "--spd") == 0) 
+        {
+            args.spd = std::stoi(argv[i+1]) > 0;
+        } else 
+        {
+            cout << "Invalid option " << argv[i] << endl;
+            print_help(argv[0]);
+            return 1;
+        }
+    }
+
+    // hardware counters inherit into threads created after this point (OpenMP, MUMPS)
+    amd_mumps::hw_counters counters;
+    if (args.enable_perf_mode)
+        counters.open();
+
+    // -----------------------------------------
+    //   Read the matrix
+    // -----------------------------------------
+    // only the host passes irn/jcn/a to MUMPS, so only the host reads the file;
+    // decompression and I/O overlap the parsing in a pipeline thread
+    std::string read_error;
+    amd_mumps::compression comp = amd_mumps::compression::none;
+    long long header[5] = {0, 0, 0, 0, 0}; // read ok, m, n, complex, symmetric
+    if (myid == 0) {
+        auto tr = get_time::now();
+        if (amd_mumps::read_matrix(args.matrix_name, matrix, read_error, &comp)) {
+            double read_t = std::chrono::duration_cast<ns>(get_time::now() - tr).count() / 1.0e9;
+            std::cout << "Read " << args.matrix_name << " (" << (matrix.is_complex ? "complex" : "real")
+                      << ", compression " << amd_mumps::compression_name(comp) << ") in " << read_t << " s" << std::endl;
+            header[0] = 1;
+            header[1] = matrix.m;
+            header[2] = matrix.n;
+            header[3] = matrix.is_complex ? 1 : 0;
+            header[4] = matrix.symmetry == amd_mumps::matrix_symmetry::symmetric ? 1 : 0;
+        } else {
+            std::cerr << read_error << std::endl;
+        }
+    }
+    // the other ranks need the arithmetic and SYM of the input to join the same MUMPS instance
+#ifdef MUMPS_MPI
+    MPI_Bcast(header, 5, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+#endif
+    if (!header[0])
+        return 1;
+    if (myid != 0) {
+        matrix.m = static_cast<MUMPS_INT>(header[1]);
+        matrix.n = static_cast<MUMPS_INT>(header[2]);
+        matrix.nnz = 0;
+        matrix.is_complex = header[3] != 0;
+        matrix.symmetry = header[4] ? amd_mumps::matrix_symmetry::symmetric : amd_mumps::matrix_symmetry::general;
+    }
+
+    if(matrix.m != matrix.n)
+    {
+        std::cerr << "MUMPS requires a square sparse matrix that can be either unsymmetric, symmetric positive definite, or general symmetric"
+                  << std::endl;
+        return -1;
+    }
+
+    // ---------------------------------------------
+    //   Route to the arithmetic of the input
+    // ---------------------------------------------
+    int ret;
+    if (matrix.is_complex)
+    {
+#ifdef AMD_MUMPS_HAVE_ZMUMPS
+        ret = run_benchmark<ZMUMPS_STRUC_C>(args, matrix, myid, comm_size, counters);
+#else
+        std::cerr << "complex input requires MUMPS built with -DBUILD_COMPLEX16=ON" << std::endl;
+        ret = 1;
+#endif
+    }
+    else
+    {
+        ret = run_benchmark<DMUMPS_STRUC_C>(args, matrix, myid, comm_size, counters);
+    }
+
+    // MPI terminate
+#ifdef MUMPS_MPI
+    ierr = MPI_Finalize();
+#endif
+
+    return ret;
+}
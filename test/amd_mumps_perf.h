@@ -0,0 +1,244 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Measurement regimes for the MUMPS benchmark
+//
+//   hot     : warm-up calls, then the average of back-to-back hot calls
+//   cold    : last level cache swept with a flush buffer before every timed call
+//   process : only the first call of each phase in a fresh process is timed,
+//             with the cache swept before it as in the cold regime
+//
+// Hardware counters (cycles, LLC misses) are captured per timed call through
+// perf_event_open on Linux; they are reported as unavailable elsewhere.
+//
+#ifndef AMD_MUMPS_PERF_H
+#define AMD_MUMPS_PERF_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace amd_mumps {
+
+enum class bench_regime { hot, cold, process };
+
+inline bool parse_bench_regime(const std::string& s, bench_regime& r)
+{
+    if (s == "hot") { r = bench_regime::hot; return true; }
+    if (s == "cold") { r = bench_regime::cold; return true; }
+    if (s == "process") { r = bench_regime::process; return true; }
+    return false;
+}
+
+inline const char* regime_name(bench_regime r)
+{
+    return r == bench_regime::cold ? "cold" : r == bench_regime::process ? "process" : "hot";
+}
+
+/*
+    size in bytes of the last level cache seen by the calling core, 0 if unknown
+*/
+inline std::size_t llc_size()
+{
+#if defined(_WIN32)
+    DWORD len = 0;
+    GetLogicalProcessorInformation(nullptr, &len);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (info.empty() || !GetLogicalProcessorInformation(info.data(), &len))
+        return 0;
+    std::size_t size = 0;
+    for (const auto& i : info)
+        if (i.Relationship == RelationCache && i.Cache.Level == 3)
+            size = (std::max)(size, static_cast<std::size_t>(i.Cache.Size));
+    return size;
+#elif defined(_SC_LEVEL3_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    return size > 0 ? static_cast<std::size_t>(size) : 0;
+#else
+    return 0;
+#endif
+}
+
+/*
+    Evicts the caches by writing then reading a buffer larger than the LLC.
+    The sweep is split across the OpenMP threads so the private caches of
+    every core running MUMPS threads are flushed as well.
+*/
+class cache_flusher {
+public:
+    /* bytes = 0 selects 8x the detected LLC size, at least 256 MB */
+    explicit cache_flusher(std::size_t bytes = 0)
+    {
+        if (bytes == 0)
+            bytes = (std::max)(static_cast<std::size_t>(256) << 20, 8 * llc_size());
+        buf_.resize(bytes / sizeof(double), 0.0);
+    }
+
+    void flush()
+    {
+        const long long n = static_cast<long long>(buf_.size());
+        double* b = buf_.data();
+        double s = 0.0;
+        #pragma omp parallel for reduction(+:s)
+        for (long long i = 0; i < n; i++) {
+            b[i] += 1.0;
+            s += b[i];
+        }
+        sink_ = s;
+    }
+
+    std::size_t bytes() const { return buf_.size() * sizeof(double); }
+
+private:
+    std::vector<double> buf_;
+    volatile double sink_ = 0.0;
+};
+
+/*
+    Counter values accumulated over one or more timed calls
+*/
+struct hw_sample {
+    std::uint64_t cycles = 0;
+    std::uint64_t llc_misses = 0;
+
+    hw_sample& operator+=(const hw_sample& o)
+    {
+        cycles += o.cycles;
+        llc_misses += o.llc_misses;
+        return *this;
+    }
+};
+
+/*
+    Process wide cycle and LLC miss counters.
+    Counters are opened with inherit set, so open() must be called before
+    the OpenMP and MPI threads are spawned for their counts to be included.
+*/
+class hw_counters {
+public:
+    hw_counters() = default;
+    ~hw_counters() { close(); }
+
+    hw_counters(const hw_counters&) = delete;
+    hw_counters& operator=(const hw_counters&) = delete;
+
+    bool open()
+    {
+#if defined(__linux__)
+        fd_cycles_ = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        // generic LL read miss first, not every core PMU maps it (e.g. Zen)
+        fd_llc_ = open_event(PERF_TYPE_HW_CACHE,
+                             PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        if (fd_llc_ < 0)
+            fd_llc_ = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+        return available();
+    }
+
+    void close()
+    {
+#if defined(__linux__)
+        if (fd_cycles_ >= 0) ::close(fd_cycles_);
+        if (fd_llc_ >= 0) ::close(fd_llc_);
+#endif
+        fd_cycles_ = fd_llc_ = -1;
+    }
+
+    bool available() const { return fd_cycles_ >= 0 || fd_llc_ >= 0; }
+
+    void start()
+    {
+        start_ = read_all();
+    }
+
+    /* counts since the matching start() */
+    hw_sample stop() const
+    {
+        hw_sample end = read_all();
+        hw_sample d;
+        d.cycles = end.cycles - start_.cycles;
+        d.llc_misses = end.llc_misses - start_.llc_misses;
+        return d;
+    }
+
+private:
+#if defined(__linux__)
+    static int open_event(std::uint32_t type, std::uint64_t config)
+    {
+        struct perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static std::uint64_t read_fd(int fd)
+    {
+        std::uint64_t v = 0;
+        if (fd < 0 || ::read(fd, &v, sizeof(v)) != static_cast<ssize_t>(sizeof(v)))
+            return 0;
+        return v;
+    }
+#endif
+
+    hw_sample read_all() const
+    {
+        hw_sample s;
+#if defined(__linux__)
+        s.cycles = read_fd(fd_cycles_);
+        s.llc_misses = read_fd(fd_llc_);
+#endif
+        return s;
+    }
+
+    int fd_cycles_ = -1;
+    int fd_llc_ = -1;
+    hw_sample start_;
+};
+
+} // namespace amd_mumps
+
+#endif // AMD_MUMPS_PERF_H
@@ -0,0 +1,758 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Streaming sparse matrix input for the MUMPS benchmark
+//
+// Supported inputs, plain or gzip/xz compressed (detected from the magic bytes):
+//   - Matrix Market, coordinate or array, real/integer/complex/pattern fields,
+//     general/symmetric/skew-symmetric/hermitian structures
+//   - Harwell-Boeing and Rutherford-Boeing assembled matrices (R/C/P/I, S/U/H/Z/R)
+//
+// Reading and decompression run in a producer thread that fills a bounded
+// queue of chunks while the calling thread parses, so multi-GB archives are
+// never inflated to disk.
+//
+// Skew-symmetric and hermitian matrices have no MUMPS equivalent and are
+// expanded to general storage. Symmetric matrices keep one triangle.
+// Pattern matrices get diagonally dominant values: -1 off the diagonal and
+// the row degree + 1 on the diagonal.
+//
+#ifndef AMD_MUMPS_READER_H
+#define AMD_MUMPS_READER_H
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef AMD_MUMPS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef AMD_MUMPS_HAVE_LZMA
+#include <lzma.h>
+#endif
+
+namespace amd_mumps {
+
+/*
+    structure of the stored entries after reading
+    general   : all entries stored
+    symmetric : one triangle stored
+*/
+enum class matrix_symmetry { general, symmetric };
+
+enum class compression { none, gzip, xz };
+
+inline const char* compression_name(compression c)
+{
+    return c == compression::gzip ? "gzip" : c == compression::xz ? "xz" : "none";
+}
+
+/*
+    Bounded producer/consumer stream of text lines.
+    The producer thread reads the file and decompresses it chunk by chunk.
+*/
+class input_stream {
+public:
+    explicit input_stream(const std::string& path, std::size_t chunk_bytes = 4u << 20, std::size_t depth = 4)
+        : path_(path), chunk_bytes_(chunk_bytes), depth_(depth) {}
+
+    ~input_stream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        not_full_.notify_all();
+        if (producer_.joinable())
+            producer_.join();
+        if (file_)
+            std::fclose(file_);
+    }
+
+    input_stream(const input_stream&) = delete;
+    input_stream& operator=(const input_stream&) = delete;
+
+    /* open the file, detect compression and start the producer thread */
+    bool open(std::string& err)
+    {
+        file_ = std::fopen(path_.c_str(), "rb");
+        if (!file_) {
+            err = "Failed to open file " + path_;
+            return false;
+        }
+        unsigned char magic[6] = {0};
+        std::size_t got = std::fread(magic, 1, sizeof(magic), file_);
+        std::rewind(file_);
+        if (got >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+            comp_ = compression::gzip;
+        else if (got == 6 && std::memcmp(magic, "\xFD" "7zXZ\0", 6) == 0)
+            comp_ = compression::xz;
+        else if (got >= 3 && std::memcmp(magic, "BZh", 3) == 0) {
+            err = "bzip2 compressed input not supported: " + path_;
+            return false;
+        }
+#ifndef AMD_MUMPS_HAVE_ZLIB
+        if (comp_ == compression::gzip) {
+            err = "gzip input requires building with zlib: " + path_;
+            return false;
+        }
+#endif
+#ifndef AMD_MUMPS_HAVE_LZMA
+        if (comp_ == compression::xz) {
+            err = "xz input requires building with liblzma: " + path_;
+            return false;
+        }
+#endif
+        producer_ = std::thread(&input_stream::produce, this);
+        return true;
+    }
+
+    /* next line without its terminator, false at end of stream */
+    bool getline(std::string& line)
+    {
+        line.clear();
+        for (;;) {
+            if (pos_ < cur_.size()) {
+                const char* begin = cur_.data() + pos_;
+                const char* nl = static_cast<const char*>(std::memchr(begin, '\n', cur_.size() - pos_));
+                if (nl) {
+                    line.append(begin, nl);
+                    pos_ += (nl - begin) + 1;
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    return true;
+                }
+                line.append(begin, cur_.size() - pos_);
+                pos_ = cur_.size();
+            }
+            if (!next_chunk()) {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                return !line.empty();
+            }
+        }
+    }
+
+    compression kind() const { return comp_; }
+
+    /* error raised by the producer thread (I/O or corrupt archive), empty if none */
+    std::string error()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return error_;
+    }
+
+private:
+    bool next_chunk()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait(lock, [this] { return !queue_.empty() || done_; });
+        if (queue_.empty())
+            return false;
+        cur_.swap(queue_.front());
+        queue_.pop_front();
+        pos_ = 0;
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /* hand a decoded chunk to the consumer, false if the consumer is gone */
+    bool push(std::vector<char>& chunk)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [this] { return queue_.size() < depth_ || stop_; });
+        if (stop_)
+            return false;
+        queue_.emplace_back();
+        queue_.back().swap(chunk);
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    void fail(const std::string& msg)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        error_ = msg;
+    }
+
+    void produce()
+    {
+        if (comp_ == compression::none)
+            produce_plain();
+#ifdef AMD_MUMPS_HAVE_ZLIB
+        else if (comp_ == compression::gzip)
+            produce_gzip();
+#endif
+#ifdef AMD_MUMPS_HAVE_LZMA
+        else if (comp_ == compression::xz)
+            produce_xz();
+#endif
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            done_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+    void produce_plain()
+    {
+        for (;;) {
+            std::vector<char> chunk(chunk_bytes_);
+            std::size_t got = std::fread(chunk.data(), 1, chunk.size(), file_);
+            if (got == 0)
+                break;
+            chunk.resize(got);
+            if (!push(chunk))
+                return;
+        }
+        if (std::ferror(file_))
+            fail("Read error on " + path_);
+    }
+
+#ifdef AMD_MUMPS_HAVE_ZLIB
+    void produce_gzip()
+    {
+        z_stream zs = {};
+        // 15 + 32: zlib or gzip header auto detection
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+            fail("zlib initialization failed");
+            return;
+        }
+        std::vector<unsigned char> in(chunk_bytes_);
+        std::vector<char> out(chunk_bytes_);
+        int ret = Z_OK;
+        for (;;) {
+            if (zs.avail_in == 0) {
+                zs.avail_in = static_cast<uInt>(std::fread(in.data(), 1, in.size(), file_));
+                zs.next_in = in.data();
+                if (zs.avail_in == 0)
+                    break;
+            }
+            do {
+                zs.next_out = reinterpret_cast<Bytef*>(out.data());
+                zs.avail_out = static_cast<uInt>(out.size());
+                ret = inflate(&zs, Z_NO_FLUSH);
+                if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                    fail("Corrupt gzip stream in " + path_);
+                    inflateEnd(&zs);
+                    return;
+                }
+                std::size_t have = out.size() - zs.avail_out;
+                if (have) {
+                    out.resize(have);
+                    if (!push(out)) {
+                        inflateEnd(&zs);
+                        return;
+                    }
+                    out.resize(chunk_bytes_);
+                }
+            } while (zs.avail_out == 0 && ret != Z_STREAM_END);
+            // concatenated gzip members
+            if (ret == Z_STREAM_END)
+                inflateReset(&zs);
+        }
+        if (ret != Z_STREAM_END)
+            fail("Truncated gzip stream in " + path_);
+        inflateEnd(&zs);
+    }
+#endif
+
+#ifdef AMD_MUMPS_HAVE_LZMA
+    void produce_xz()
+    {
+        lzma_stream xs = LZMA_STREAM_INIT;
+        if (lzma_stream_decoder(&xs, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+            fail("liblzma initialization failed");
+            return;
+        }
+        std::vector<unsigned char> in(chunk_bytes_);
+        std::vector<char> out(chunk_bytes_);
+        lzma_action action = LZMA_RUN;
+        for (;;) {
+            if (xs.avail_in == 0 && action == LZMA_RUN) {
+                xs.avail_in = std::fread(in.data(), 1, in.size(), file_);
+                xs.next_in = in.data();
+                if (xs.avail_in == 0)
+                    action = LZMA_FINISH;
+            }
+            xs.next_out = reinterpret_cast<uint8_t*>(out.data());
+            xs.avail_out = out.size();
+            lzma_ret ret = lzma_code(&xs, action);
+            std::size_t have = out.size() - xs.avail_out;
+            if (have) {
+                out.resize(have);
+                if (!push(out))
+                    break;
+                out.resize(chunk_bytes_);
+            }
+            if (ret == LZMA_STREAM_END)
+                break;
+            if (ret != LZMA_OK) {
+                fail("Corrupt xz stream in " + path_);
+                break;
+            }
+        }
+        lzma_end(&xs);
+    }
+#endif
+
+    std::string path_;
+    std::size_t chunk_bytes_;
+    std::size_t depth_;
+    std::FILE* file_ = nullptr;
+    compression comp_ = compression::none;
+    std::thread producer_;
+
+    std::mutex mtx_;
+    std::condition_variable not_empty_, not_full_;
+    std::deque<std::vector<char>> queue_;
+    bool done_ = false;
+    bool stop_ = false;
+    std::string error_;
+
+    // consumer side, only touched by the parsing thread
+    std::vector<char> cur_;
+    std::size_t pos_ = 0;
+};
+
+namespace detail {
+
+inline std::string to_lower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+inline bool blank(const std::string& s)
+{
+    return s.find_first_not_of(" \t") == std::string::npos;
+}
+
+/* fixed column field of a card, blank padding removed; empty past the end of the line */
+inline std::string column(const std::string& line, std::size_t pos, std::size_t len)
+{
+    if (pos >= line.size())
+        return std::string();
+    std::string f = line.substr(pos, len);
+    std::size_t b = f.find_first_not_of(" \t");
+    if (b == std::string::npos)
+        return std::string();
+    return f.substr(b, f.find_last_not_of(" \t") - b + 1);
+}
+
+/*
+    Collects entries and applies the storage conversions shared by the
+    Matrix Market and Harwell/Rutherford-Boeing readers.
+*/
+template<typename COO>
+class coo_builder {
+public:
+    coo_builder(COO& A, bool cplx, bool pattern, char sym) : A_(A), cplx_(cplx), pattern_(pattern), sym_(sym) {}
+
+    /* sym: 'g' general, 's' symmetric, 'k' skew-symmetric, 'h' hermitian */
+    void reserve(std::size_t nnz)
+    {
+        std::size_t n = (sym_ == 'k' || sym_ == 'h') ? 2 * nnz : nnz;
+        A_.row_idxs.reserve(n);
+        A_.col_idxs.reserve(n);
+        A_.values.reserve(cplx_ ? 2 * n : n);
+    }
+
+    void add(long long i, long long j, double re, double im)
+    {
+        if (sym_ == 'k' && i == j)
+            return; // zero by definition
+        push(i, j, re, im);
+        if (i != j && sym_ == 'k')
+            push(j, i, -re, -im);
+        else if (i != j && sym_ == 'h')
+            push(j, i, re, -im);
+    }
+
+    void finish()
+    {
+        if (pattern_)
+            pattern_values();
+        A_.nnz = static_cast<decltype(A_.nnz)>(A_.row_idxs.size());
+        A_.is_complex = cplx_;
+        A_.symmetry = sym_ == 's' ? matrix_symmetry::symmetric : matrix_symmetry::general;
+    }
+
+private:
+    void push(long long i, long long j, double re, double im)
+    {
+        A_.row_idxs.push_back(static_cast<typename decltype(A_.row_idxs)::value_type>(i));
+        A_.col_idxs.push_back(static_cast<typename decltype(A_.col_idxs)::value_type>(j));
+        A_.values.push_back(re);
+        if (cplx_)
+            A_.values.push_back(im);
+    }
+
+    void pattern_values()
+    {
+        const std::size_t stride = cplx_ ? 2 : 1;
+        const std::size_t nz = A_.row_idxs.size();
+        const std::size_t dim = static_cast<std::size_t>((std::max)(A_.m, A_.n)) + 1;
+        std::vector<double> rdeg(dim, 0.0), cdeg(dim, 0.0);
+        std::vector<long long> diag(dim, -1);
+        for (std::size_t k = 0; k < nz; k++) {
+            long long i = A_.row_idxs[k], j = A_.col_idxs[k];
+            if (i == j) {
+                diag[i] = static_cast<long long>(k);
+                continue;
+            }
+            A_.values[k * stride] = -1.0;
+            rdeg[i] += 1.0;
+            cdeg[j] += 1.0;
+            if (sym_ == 's') {
+                rdeg[j] += 1.0;
+                cdeg[i] += 1.0;
+            }
+        }
+        for (long long d = 1; d <= static_cast<long long>((std::min)(A_.m, A_.n)); d++) {
+            double v = (std::max)(rdeg[d], cdeg[d]) + 1.0;
+            if (diag[d] >= 0)
+                A_.values[diag[d] * stride] = v;
+            else
+                push(d, d, v, 0.0);
+        }
+    }
+
+    COO& A_;
+    bool cplx_;
+    bool pattern_;
+    char sym_;
+};
+
+/*
+    repeat count and field width of a Fortran edit descriptor such as
+    (10I8), (4E20.12), (3ES25.16), (1P,4D20.12) or (1P5E16.8)
+*/
+struct fortran_format {
+    int count = 0;
+    int width = 0;
+};
+
+inline fortran_format parse_fortran_format(const std::string& fmt)
+{
+    fortran_format f;
+    std::string s = to_lower(fmt);
+    for (std::size_t k = 0; k < s.size(); k++) {
+        char c = s[k];
+        if (c != 'i' && c != 'e' && c != 'd' && c != 'f' && c != 'g')
+            continue;
+        // width follows the descriptor letter, or ES/EN for scientific/engineering notation
+        std::size_t d = k + 1;
+        if (c == 'e' && d < s.size() && (s[d] == 's' || s[d] == 'n'))
+            d++;
+        std::size_t w = d;
+        while (w < s.size() && std::isdigit(static_cast<unsigned char>(s[w])))
+            w++;
+        if (w == d)
+            continue;
+        // repeat count precedes it, after any "nP" scale factor
+        std::size_t r = k;
+        while (r > 0 && std::isdigit(static_cast<unsigned char>(s[r - 1])))
+            r--;
+        f.count = r < k ? std::atoi(s.substr(r, k - r).c_str()) : 1;
+        f.width = std::atoi(s.substr(d, w - d).c_str());
+        break;
+    }
+    return f;
+}
+
+/*
+    read the next n fixed width fields, spanning as many lines as needed
+*/
+template<typename T>
+bool read_fixed(input_stream& in, const fortran_format& f, std::size_t n, std::vector<T>& out, bool real)
+{
+    out.clear();
+    out.reserve(n);
+    std::string line, field;
+    while (out.size() < n && in.getline(line)) {
+        for (int k = 0; k < f.count && out.size() < n; k++) {
+            std::size_t start = static_cast<std::size_t>(k) * f.width;
+            if (start >= line.size())
+                break;
+            field = line.substr(start, f.width);
+            if (blank(field))
+                continue;
+            if (real) {
+                // Fortran D exponents
+                std::replace(field.begin(), field.end(), 'D', 'E');
+                std::replace(field.begin(), field.end(), 'd', 'e');
+                out.push_back(static_cast<T>(std::strtod(field.c_str(), nullptr)));
+            } else {
+                out.push_back(static_cast<T>(std::strtoll(field.c_str(), nullptr, 10)));
+            }
+        }
+    }
+    return out.size() == n;
+}
+
+template<typename COO>
+bool read_matrix_market(input_stream& in, const std::string& banner, COO& A, std::string& err)
+{
+    char fmt[64] = {0}, field[64] = {0}, symm[64] = {0};
+    if (std::sscanf(to_lower(banner).c_str(), "%%%%matrixmarket matrix %63s %63s %63s", fmt, field, symm) != 3) {
+        err = "Invalid Matrix Market header banner: " + banner;
+        return false;
+    }
+    std::string format = fmt, arith = field, structure = symm;
+    if (format != "coordinate" && format != "array") {
+        err = "Invalid Matrix format in the header banner: " + format;
+        return false;
+    }
+    if (arith != "real" && arith != "complex" && arith != "integer" && arith != "pattern") {
+        err = "Invalid arithmetic field in the header banner: " + arith;
+        return false;
+    }
+    if (structure != "general" && structure != "symmetric" && structure != "skew-symmetric" && structure != "hermitian") {
+        err = "Invalid symmetry structure in the header banner: " + structure;
+        return false;
+    }
+    const bool cplx = arith == "complex";
+    const bool pattern = arith == "pattern";
+    const bool coordinate = format == "coordinate";
+    if (pattern && !coordinate) {
+        err = "pattern field requires coordinate format";
+        return false;
+    }
+    const char sym = structure == "general" ? 'g' : structure == "symmetric" ? 's' : structure == "skew-symmetric" ? 'k' : 'h';
+    if (sym == 'h' && !cplx) {
+        // real hermitian is symmetric
+        return read_matrix_market(in, "%%MatrixMarket matrix " + format + " " + arith + " symmetric", A, err);
+    }
+
+    std::string line;
+    do {
+        if (!in.getline(line)) {
+            err = "Missing size line";
+            return false;
+        }
+    } while (blank(line) || line[0] == '%');
+
+    long long m = 0, n = 0, nnz = 0;
+    int got = std::sscanf(line.c_str(), "%lld %lld %lld", &m, &n, &nnz);
+    if ((coordinate && got != 3) || (!coordinate && got < 2)) {
+        err = "Invalid size line: " + line;
+        return false;
+    }
+    if (!coordinate)
+        nnz = sym == 'g' ? m * n : sym == 'k' ? n * (n - 1) / 2 : n * (n + 1) / 2;
+    A.m = static_cast<decltype(A.m)>(m);
+    A.n = static_cast<decltype(A.n)>(n);
+
+    coo_builder<COO> b(A, cplx, pattern, sym);
+    b.reserve(static_cast<std::size_t>(nnz));
+    long long read = 0;
+    long long ai = sym == 'k' ? 2 : 1, aj = 1; // array format position, column major
+    while (read < nnz && in.getline(line)) {
+        if (blank(line) || line[0] == '%')
+            continue;
+        char* p = &line[0];
+        char* end = nullptr;
+        long long i, j;
+        if (coordinate) {
+            i = std::strtoll(p, &end, 10);
+            j = std::strtoll(end, &end, 10);
+            p = end;
+        } else {
+            i = ai;
+            j = aj;
+            // lower triangle only for symmetric storage, strictly lower for skew
+            ai++;
+            if (ai > m) {
+                aj++;
+                ai = sym == 'g' ? 1 : sym == 'k' ? aj + 1 : aj;
+            }
+        }
+        double re = 0.0, im = 0.0;
+        if (!pattern) {
+            re = std::strtod(p, &end);
+            p = end;
+            if (cplx)
+                im = std::strtod(p, &end);
+        }
+        //negative indices since row/col indices are not 1-based, which is expected in mtx/coo format
+        if (i < 1 || j < 1 || i > m || j > n) {
+            err = "Entry out of range: " + line;
+            return false;
+        }
+        if (coordinate || re != 0.0 || im != 0.0)
+            b.add(i, j, re, im);
+        read++;
+    }
+    if (read < nnz) {
+        err = "Unexpected end of file after " + std::to_string(read) + " of " + std::to_string(nnz) + " entries";
+        return false;
+    }
+    b.finish();
+    return true;
+}
+
+template<typename COO>
+bool read_boeing(input_stream& in, COO& A, std::string& err)
+{
+    // line 1 (title and key) was consumed by the caller
+    std::string line;
+    long long crd[5] = {0, 0, 0, 0, 0};
+    if (!in.getline(line)) {
+        err = "Truncated Harwell/Rutherford-Boeing header";
+        return false;
+    }
+    // Harwell-Boeing has a fifth RHSCRD card count, Rutherford-Boeing does not
+    std::sscanf(line.c_str(), "%lld %lld %lld %lld %lld", &crd[0], &crd[1], &crd[2], &crd[3], &crd[4]);
+    const long long rhscrd = crd[4];
+
+    if (!in.getline(line) || line.size() < 3) {
+        err = "Truncated Harwell/Rutherford-Boeing header";
+        return false;
+    }
+    std::string type = to_lower(line.substr(0, 3));
+    long long nrow = 0, ncol = 0, nnz = 0;
+    if (std::sscanf(line.c_str() + 3, "%lld %lld %lld", &nrow, &ncol, &nnz) != 3) {
+        err = "Invalid Harwell/Rutherford-Boeing dimensions: " + line;
+        return false;
+    }
+    if (type[2] != 'a') {
+        err = "Only assembled Harwell/Rutherford-Boeing matrices are supported, type " + type;
+        return false;
+    }
+    if (type[0] != 'r' && type[0] != 'c' && type[0] != 'p' && type[0] != 'i') {
+        err = "Unsupported Harwell/Rutherford-Boeing value type " + type;
+        return false;
+    }
+    const bool cplx = type[0] == 'c';
+    const bool pattern = type[0] == 'p';
+    char sym;
+    switch (type[1]) {
+    case 's': sym = 's'; break;
+    case 'u': case 'r': sym = 'g'; break;
+    case 'h': sym = cplx ? 'h' : 's'; break;
+    case 'z': sym = 'k'; break;
+    default:
+        err = "Unsupported Harwell/Rutherford-Boeing structure type " + type;
+        return false;
+    }
+
+    if (!in.getline(line)) {
+        err = "Truncated Harwell/Rutherford-Boeing header";
+        return false;
+    }
+    // format card (2A16,2A20): a format may fill its columns, so it is not split on blanks
+    std::string ptrfmt = column(line, 0, 16), indfmt = column(line, 16, 16), valfmt = column(line, 32, 20);
+    if (ptrfmt.empty() || indfmt.empty() || (!pattern && valfmt.empty())) {
+        err = "Invalid Harwell/Rutherford-Boeing format line: " + line;
+        return false;
+    }
+    if (rhscrd > 0 && !in.getline(line)) {
+        err = "Truncated Harwell-Boeing right-hand side header";
+        return false;
+    }
+
+    fortran_format fp = parse_fortran_format(ptrfmt), fi = parse_fortran_format(indfmt), fv;
+    if (!pattern)
+        fv = parse_fortran_format(valfmt);
+    if (fp.width <= 0 || fi.width <= 0 || (!pattern && fv.width <= 0)) {
+        err = "Unsupported Fortran format " + ptrfmt + " " + indfmt + " " + valfmt;
+        return false;
+    }
+
+    std::vector<long long> colptr, rowind;
+    std::vector<double> vals;
+    if (!read_fixed(in, fp, static_cast<std::size_t>(ncol + 1), colptr, false) ||
+        !read_fixed(in, fi, static_cast<std::size_t>(nnz), rowind, false) ||
+        (!pattern && !read_fixed(in, fv, static_cast<std::size_t>(cplx ? 2 * nnz : nnz), vals, true))) {
+        err = "Unexpected end of Harwell/Rutherford-Boeing data";
+        return false;
+    }
+
+    A.m = static_cast<decltype(A.m)>(nrow);
+    A.n = static_cast<decltype(A.n)>(ncol);
+    coo_builder<COO> b(A, cplx, pattern, sym);
+    b.reserve(static_cast<std::size_t>(nnz));
+    for (long long j = 0; j < ncol; j++) {
+        for (long long k = colptr[j] - 1; k < colptr[j + 1] - 1; k++) {
+            if (k < 0 || k >= nnz || rowind[k] < 1 || rowind[k] > nrow) {
+                err = "Corrupt Harwell/Rutherford-Boeing column pointers";
+                return false;
+            }
+            double re = pattern ? 0.0 : cplx ? vals[2 * k] : vals[k];
+            double im = cplx ? vals[2 * k + 1] : 0.0;
+            b.add(rowind[k], j + 1, re, im);
+        }
+    }
+    b.finish();
+    return true;
+}
+
+} // namespace detail
+
+/*
+    Read a sparse matrix into COO storage with 1-based indices.
+    COO must provide m, n, nnz, row_idxs, col_idxs, values (interleaved
+    real/imaginary parts when complex), is_complex and symmetry.
+*/
+template<typename COO>
+bool read_matrix(const std::string& path, COO& A, std::string& err, compression* comp = nullptr)
+{
+    input_stream in(path);
+    if (!in.open(err))
+        return false;
+    if (comp)
+        *comp = in.kind();
+
+    std::string first;
+    if (!in.getline(first)) {
+        err = in.error().empty() ? "Empty input file " + path : in.error();
+        return false;
+    }
+    bool ok = first.compare(0, 2, "%%") == 0
+        ? detail::read_matrix_market(in, first, A, err)
+        : detail::read_boeing(in, A, err);
+    // a decompression failure surfaces as a truncated file, report the cause
+    if (!in.error().empty()) {
+        err = in.error();
+        return false;
+    }
+    return ok;
+}
+
+} // namespace amd_mumps
+
+#endif // AMD_MUMPS_READER_H
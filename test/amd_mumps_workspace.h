@@ -0,0 +1,395 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Reusable, huge page backed and NUMA placed factorization workspace
+//          handed to MUMPS through WK_USER/LWK_USER
+//
+// The workspace is sized from the analysis estimate (INFO(8) in-core,
+// INFO(20) out-of-core), allocated once per MPI rank and kept alive across
+// repeated JOB=2/JOB=3 calls so that only the first factorization pays for
+// page faults and first-touch placement.
+//
+#ifndef AMD_MUMPS_WORKSPACE_H
+#define AMD_MUMPS_WORKSPACE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#endif
+
+namespace amd_mumps {
+
+/*
+    page backing of the workspace
+    standard  : regular 4K pages
+    thp       : transparent huge pages (madvise on Linux, large pages with fallback on Windows)
+    explicit  : explicit huge pages (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows), falls back to thp
+*/
+enum class page_policy { standard, thp, explicit_huge };
+
+/*
+    NUMA placement of the workspace
+    none       : OS default (first touch)
+    local      : bound to the NUMA node of the calling rank
+    interleave : interleaved across all online NUMA nodes (Linux only)
+*/
+enum class numa_policy { none, local, interleave };
+
+inline bool parse_page_policy(const std::string& s, page_policy& p)
+{
+    if (s == "none" || s == "standard") { p = page_policy::standard; return true; }
+    if (s == "thp") { p = page_policy::thp; return true; }
+    if (s == "explicit") { p = page_policy::explicit_huge; return true; }
+    return false;
+}
+
+inline bool parse_numa_policy(const std::string& s, numa_policy& p)
+{
+    if (s == "none") { p = numa_policy::none; return true; }
+    if (s == "local") { p = numa_policy::local; return true; }
+    if (s == "interleave") { p = numa_policy::interleave; return true; }
+    return false;
+}
+
+/*
+    page fault counters of the calling process
+*/
+struct page_faults {
+    std::uint64_t minor = 0;
+    std::uint64_t major = 0;
+};
+
+inline page_faults read_page_faults()
+{
+    page_faults pf;
+#if defined(_WIN32)
+    // Windows does not distinguish soft/hard faults here, report all as minor
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        pf.minor = pmc.PageFaultCount;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        pf.minor = static_cast<std::uint64_t>(ru.ru_minflt);
+        pf.major = static_cast<std::uint64_t>(ru.ru_majflt);
+    }
+#endif
+    return pf;
+}
+
+/*
+    Growable workspace of T entries. reserve() only reallocates when a larger
+    size is requested, so the same pages are reused across factorizations.
+*/
+template<typename T>
+class workspace {
+public:
+    workspace(page_policy pages = page_policy::thp, numa_policy numa = numa_policy::local)
+        : pages_(pages), numa_(numa) {}
+    ~workspace() { release(); }
+
+    workspace(const workspace&) = delete;
+    workspace& operator=(const workspace&) = delete;
+
+    /* make room for at least n entries, returns false on allocation failure */
+    bool reserve(std::size_t n)
+    {
+        if (n <= entries_)
+            return true;
+        release();
+        std::size_t bytes = n * sizeof(T);
+        if (!allocate(bytes))
+            return false;
+        entries_ = n;
+        first_touch();
+        return true;
+    }
+
+    void release()
+    {
+        if (!ptr_)
+            return;
+#if defined(_WIN32)
+        VirtualFree(ptr_, 0, MEM_RELEASE);
+#else
+        munmap(ptr_, bytes_);
+#endif
+        ptr_ = nullptr;
+        bytes_ = 0;
+        entries_ = 0;
+        explicit_huge_ = false;
+        advised_ = false;
+    }
+
+    T* data() const { return static_cast<T*>(ptr_); }
+    std::size_t size() const { return entries_; }
+    std::size_t bytes() const { return bytes_; }
+    /*
+        Bytes of the workspace actually backed by huge pages. Explicit huge
+        pages are all or nothing; transparent huge pages are read back from
+        /proc/self/smaps, since madvise succeeds even when THP is disabled
+        or the kernel could not find free huge pages.
+    */
+    std::size_t huge_page_bytes() const
+    {
+        if (explicit_huge_)
+            return bytes_;
+#if !defined(_WIN32)
+        if (advised_)
+            return thp_bytes();
+#endif
+        return 0;
+    }
+
+private:
+    static constexpr std::size_t huge_page_size = 2u << 20;
+
+    static std::size_t round_up(std::size_t v, std::size_t a) { return (v + a - 1) / a * a; }
+
+#if defined(_WIN32)
+    /*
+        Holding the "Lock pages in memory" user right is not enough: the
+        privilege is disabled in the process token until it is adjusted.
+    */
+    static bool enable_lock_memory_privilege()
+    {
+        static const bool enabled = [] {
+            HANDLE token;
+            if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+                return false;
+            TOKEN_PRIVILEGES tp = {};
+            tp.PrivilegeCount = 1;
+            tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+            bool ok = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid) &&
+                      AdjustTokenPrivileges(token, FALSE, &tp, 0, nullptr, nullptr) &&
+                      GetLastError() == ERROR_SUCCESS; // ERROR_NOT_ALL_ASSIGNED: right not granted
+            CloseHandle(token);
+            return ok;
+        }();
+        return enabled;
+    }
+
+    bool allocate(std::size_t bytes)
+    {
+        DWORD node = NUMA_NO_PREFERRED_NODE;
+        if (numa_ == numa_policy::local) {
+            PROCESSOR_NUMBER pn;
+            USHORT n;
+            GetCurrentProcessorNumberEx(&pn);
+            if (GetNumaProcessorNodeEx(&pn, &n))
+                node = n;
+        }
+        // interleave has no Win32 equivalent, leave placement to first touch
+
+        if (pages_ != page_policy::standard) {
+            // large pages need SeLockMemoryPrivilege enabled in the token, fall back silently if not granted
+            SIZE_T large = GetLargePageMinimum();
+            if (large && enable_lock_memory_privilege()) {
+                bytes_ = round_up(bytes, large);
+                ptr_ = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes_,
+                                          MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+                if (ptr_) {
+                    explicit_huge_ = true;
+                    return true;
+                }
+            }
+        }
+        bytes_ = round_up(bytes, 4096);
+        ptr_ = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes_,
+                                  MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+        return ptr_ != nullptr;
+    }
+#else
+    bool allocate(std::size_t bytes)
+    {
+        bytes_ = round_up(bytes, huge_page_size);
+#ifdef MAP_HUGETLB
+        if (pages_ == page_policy::explicit_huge) {
+            ptr_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr_ == MAP_FAILED)
+                ptr_ = nullptr;
+            else
+                explicit_huge_ = true;
+        }
+#endif
+        if (!ptr_) {
+            ptr_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr_ == MAP_FAILED) {
+                ptr_ = nullptr;
+                bytes_ = 0;
+                return false;
+            }
+#ifdef MADV_HUGEPAGE
+            if (pages_ != page_policy::standard)
+                advised_ = madvise(ptr_, bytes_, MADV_HUGEPAGE) == 0;
+#endif
+        }
+        bind();
+        return true;
+    }
+
+    /* apply the NUMA policy through mbind(2) directly, avoids a libnuma dependency */
+    void bind()
+    {
+#ifdef SYS_mbind
+        const int mpol_interleave = 3;
+        const int mpol_local = 4;
+        if (numa_ == numa_policy::local) {
+            syscall(SYS_mbind, ptr_, bytes_, mpol_local, nullptr, 0UL, 0U);
+        } else if (numa_ == numa_policy::interleave) {
+            std::vector<unsigned long> mask;
+            unsigned long maxnode = online_nodes(mask);
+            if (maxnode > 1)
+                syscall(SYS_mbind, ptr_, bytes_, mpol_interleave, mask.data(), maxnode + 1, 0U);
+        }
+#endif
+    }
+
+    /* AnonHugePages of the mappings overlapping the workspace */
+    std::size_t thp_bytes() const
+    {
+        const std::uintptr_t lo = reinterpret_cast<std::uintptr_t>(ptr_);
+        const std::uintptr_t hi = lo + bytes_;
+        std::ifstream f("/proc/self/smaps");
+        std::string line;
+        bool overlap = false;
+        std::size_t kb = 0;
+        while (std::getline(f, line)) {
+            unsigned long start, end;
+            // mapping header "start-end perms ..."; field names never parse as two hex numbers
+            if (std::sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2) {
+                overlap = start < hi && end > lo;
+            } else if (overlap && line.compare(0, 14, "AnonHugePages:") == 0) {
+                kb += std::stoul(line.substr(14));
+            }
+        }
+        return (std::min)(kb << 10, bytes_);
+    }
+
+    /* parse /sys/devices/system/node/online (e.g. "0-3,6") into a nodemask */
+    static unsigned long online_nodes(std::vector<unsigned long>& mask)
+    {
+        const unsigned long bits = 8 * sizeof(unsigned long);
+        std::ifstream f("/sys/devices/system/node/online");
+        std::string list;
+        if (!f || !std::getline(f, list))
+            return 0;
+        unsigned long maxnode = 0;
+        std::size_t pos = 0;
+        while (pos < list.size()) {
+            std::size_t end = list.find(',', pos);
+            if (end == std::string::npos)
+                end = list.size();
+            std::string range = list.substr(pos, end - pos);
+            std::size_t dash = range.find('-');
+            unsigned long lo = std::stoul(range.substr(0, dash));
+            unsigned long hi = dash == std::string::npos ? lo : std::stoul(range.substr(dash + 1));
+            for (unsigned long n = lo; n <= hi; n++) {
+                if (mask.size() <= n / bits)
+                    mask.resize(n / bits + 1, 0);
+                mask[n / bits] |= 1UL << (n % bits);
+            }
+            maxnode = (std::max)(maxnode, hi + 1);
+            pos = end + 1;
+        }
+        return maxnode;
+    }
+#endif
+
+    /* fault the pages in once, outside of any timed region */
+    void first_touch()
+    {
+        std::memset(ptr_, 0, bytes_);
+    }
+
+    page_policy pages_;
+    numa_policy numa_;
+    void* ptr_ = nullptr;
+    std::size_t bytes_ = 0;
+    std::size_t entries_ = 0;
+    bool explicit_huge_ = false;   // MAP_HUGETLB / MEM_LARGE_PAGES mapping
+    bool advised_ = false;         // MADV_HUGEPAGE accepted, backing decided by the kernel
+};
+
+/*
+    Workspace size in entries required by the factorization on this rank,
+    from the analysis estimates relaxed by ICNTL(14).
+    INFO(8)/INFO(20) are given in millions of entries when negative.
+*/
+template<typename STRUC>
+std::size_t factorization_workspace_entries(const STRUC& id)
+{
+    long long est = id.icntl[21] == 0 ? id.info[7] : id.info[19];
+    if (est < 0)
+        est = -est * 1000000LL;
+    long long relax = id.icntl[13] > 0 ? id.icntl[13] : 0;
+    return static_cast<std::size_t>(est + est * relax / 100);
+}
+
+/*
+    Hand the workspace to MUMPS. LWK_USER is passed in millions of entries
+    (negative value) when it does not fit in a 32-bit MUMPS_INT.
+*/
+template<typename STRUC, typename T>
+void attach_workspace(STRUC& id, workspace<T>& wk)
+{
+    id.wk_user = wk.data();
+    long long n = static_cast<long long>(wk.size());
+    if (sizeof(id.lwk_user) < sizeof(long long) && n > 2147483647LL)
+        id.lwk_user = static_cast<decltype(id.lwk_user)>(-(n / 1000000LL));
+    else
+        id.lwk_user = static_cast<decltype(id.lwk_user)>(n);
+}
+
+template<typename STRUC>
+void detach_workspace(STRUC& id)
+{
+    id.wk_user = nullptr;
+    id.lwk_user = 0;
+}
+
+} // namespace amd_mumps
+
+#endif // AMD_MUMPS_WORKSPACE_H
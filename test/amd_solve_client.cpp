@@ -0,0 +1,291 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Local load generator for amd_solve_server
+//
+// Each client thread holds one connection and issues solve requests back to
+// back, optionally paced by a fixed interval. For every batching window in
+// the sweep the server window is updated, the load is replayed and the
+// end-to-end latency percentiles, throughput and mean batch size are reported.
+// With a latency budget, the share of requests answered within it is reported
+// as well; it should not drop when the window exceeds the budget.
+//
+// Usage : "executable" [--socket <path>] [--clients <C>] [--requests <R>] [--windows <w0,w1,...>]
+//                      [--interval_us <pacing>] [--budget_us <latency_target>] [--shutdown <0|1>]
+//
+#include "amd_solve_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using get_time = std::chrono::steady_clock;
+namespace proto = amd_mumps::solve_protocol;
+
+/*
+    connect and read the server hello, returns the fd or -1
+*/
+static int connect_server(const std::string& path, std::uint64_t& n)
+{
+    sockaddr_un addr;
+    if (!proto::make_address(path, addr))
+        return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    proto::reply hello;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        !proto::read_full(fd, &hello, sizeof(hello)) || hello.type != proto::msg_hello) {
+        ::close(fd);
+        return -1;
+    }
+    n = hello.n;
+    return fd;
+}
+
+/*
+    per client measurements of one run
+*/
+struct client_result {
+    std::vector<double> latency_us;
+    std::vector<double> queue_us;      // server side wait for the batch to close
+    std::uint64_t batch_sum = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t budget_missed = 0;
+};
+
+static void run_client(int fd, std::uint64_t n, int requests, int interval_us, std::uint32_t budget_us,
+                       unsigned seed, client_result& res)
+{
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> rhs(n), x(n);
+    res.latency_us.reserve(static_cast<std::size_t>(requests));
+    res.queue_us.reserve(static_cast<std::size_t>(requests));
+    auto next = get_time::now();
+    for (int q = 0; q < requests; q++) {
+        if (interval_us > 0) {
+            std::this_thread::sleep_until(next);
+            next += std::chrono::microseconds(interval_us);
+        }
+        for (auto& v : rhs)
+            v = dist(gen);
+        proto::request req = {};
+        req.type = proto::msg_solve;
+        req.budget_us = budget_us;
+        req.id = static_cast<std::uint64_t>(q);
+        req.n = n;
+        auto t0 = get_time::now();
+        proto::reply rep;
+        if (!proto::write_full(fd, &req, sizeof(req)) || !proto::write_full(fd, rhs.data(), n * sizeof(double)) ||
+            !proto::read_full(fd, &rep, sizeof(rep)) ||
+            (rep.n > 0 && !proto::read_full(fd, x.data(), rep.n * sizeof(double)))) {
+            res.failed += static_cast<std::uint64_t>(requests - q);
+            return;
+        }
+        double us = std::chrono::duration<double, std::micro>(get_time::now() - t0).count();
+        if (rep.status < 0) {
+            res.failed++;
+            continue;
+        }
+        res.latency_us.push_back(us);
+        res.queue_us.push_back(rep.queue_ns / 1000.0);
+        res.batch_sum += rep.batch;
+        if (budget_us > 0 && us > budget_us)
+            res.budget_missed++;
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    std::size_t k = static_cast<std::size_t>(p * sorted.size());
+    return sorted[(std::min)(k, sorted.size() - 1)];
+}
+
+/*
+    usage function
+*/
+void print_help(char* client)
+{
+    std::cout << "\nUsage: " << client << " [--socket <path>] [--clients <C>] [--requests <R>] [--windows <w0,w1,...>]"
+              << " [--interval_us <us>] [--budget_us <us>] [--shutdown <0|1>]\n";
+    std::cout << "\tpath: server socket (default " << proto::default_socket << ")\n";
+    std::cout << "\tC: concurrent client connections (default 8)\n";
+    std::cout << "\tR: solve requests per client and window (default 1000)\n";
+    std::cout << "\tw0,w1,...: batching windows to sweep in microseconds (default: keep the server window)\n";
+    std::cout << "\tinterval_us: pacing between requests of one client, 0 = back to back (default 0)\n";
+    std::cout << "\tbudget_us: per request latency target sent to the server, 0 = none (default 0)\n";
+    std::cout << "\tshutdown: 1 = stop the server when done (default 0)\n";
+}
+
+/*
+    =======main=========
+*/
+int main(int argc, char* argv[])
+{
+    std::string socket_path = proto::default_socket;
+    int clients = 8;
+    int requests = 1000;
+    int interval_us = 0;
+    std::uint32_t budget_us = 0;
+    bool shutdown = false;
+    std::vector<long long> windows;
+
+    if (argc % 2 == 0) {
+        print_help(argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "--socket") == 0) {
+            socket_path = argv[i+1];
+        } else if (strcmp(argv[i], "--clients") == 0) {
+            clients = (std::max)(1, std::stoi(argv[i+1]));
+        } else if (strcmp(argv[i], "--requests") == 0) {
+            requests = (std::max)(1, std::stoi(argv[i+1]));
+        } else if (strcmp(argv[i], "--windows") == 0) {
+            std::stringstream ss(argv[i+1]);
+            std::string w;
+            while (std::getline(ss, w, ','))
+                windows.push_back((std::max)(0LL, std::stoll(w)));
+        } else if (strcmp(argv[i], "--interval_us") == 0) {
+            interval_us = (std::max)(0, std::stoi(argv[i+1]));
+        } else if (strcmp(argv[i], "--budget_us") == 0) {
+            budget_us = static_cast<std::uint32_t>((std::max)(0, std::stoi(argv[i+1])));
+        } else if (strcmp(argv[i], "--shutdown") == 0) {
+            shutdown = std::stoi(argv[i+1]) > 0;
+        } else {
+            std::cout << "Invalid option " << argv[i] << std::endl;
+            print_help(argv[0]);
+            return 1;
+        }
+    }
+    // -1: run once with the window the server was started with
+    if (windows.empty())
+        windows.push_back(-1);
+
+    std::uint64_t n = 0;
+    std::vector<int> fds;
+    for (int c = 0; c < clients; c++) {
+        int fd = connect_server(socket_path, n);
+        if (fd < 0) {
+            std::cerr << "Failed to connect to " << socket_path << std::endl;
+            for (int f : fds)
+                ::close(f);
+            return 1;
+        }
+        fds.push_back(fd);
+    }
+
+    std::cout.setf(std::ios::left);
+    std::cout << std::setw(12) << "window_us"
+              << std::setw(12) << "clients"
+              << std::setw(12) << "requests"
+              << std::setw(12) << "failed"
+              << std::setw(16) << "throughput_rps"
+              << std::setw(12) << "p50_us"
+              << std::setw(12) << "p99_us"
+              << std::setw(12) << "max_us"
+              << std::setw(12) << "mean_batch"
+              << std::setw(14) << "p99_queue_us"
+              << std::setw(14) << "budget_missed"
+              << std::setw(12) << "budget_met%"
+              << std::endl;
+
+    for (long long w : windows) {
+        if (w >= 0) {
+            proto::request req = {};
+            req.type = proto::msg_set_window;
+            req.window_us = static_cast<std::uint64_t>(w);
+            proto::reply ack;
+            if (!proto::write_full(fds[0], &req, sizeof(req)) || !proto::read_full(fds[0], &ack, sizeof(ack))) {
+                std::cerr << "Failed to set the batching window" << std::endl;
+                return 1;
+            }
+        }
+
+        std::vector<client_result> results(static_cast<std::size_t>(clients));
+        std::vector<std::thread> threads;
+        auto t0 = get_time::now();
+        for (int c = 0; c < clients; c++)
+            threads.emplace_back(run_client, fds[c], n, requests, interval_us, budget_us,
+                                 static_cast<unsigned>(c + 1), std::ref(results[c]));
+        for (auto& t : threads)
+            t.join();
+        double elapsed = std::chrono::duration<double>(get_time::now() - t0).count();
+
+        std::vector<double> lat, queued;
+        std::uint64_t batch_sum = 0, failed = 0, missed = 0;
+        for (const auto& r : results) {
+            lat.insert(lat.end(), r.latency_us.begin(), r.latency_us.end());
+            queued.insert(queued.end(), r.queue_us.begin(), r.queue_us.end());
+            batch_sum += r.batch_sum;
+            failed += r.failed;
+            missed += r.budget_missed;
+        }
+        std::sort(lat.begin(), lat.end());
+        std::sort(queued.begin(), queued.end());
+        // with a budget the batch must close before it whatever the window, so the
+        // queue time stays below the budget and the met share stays high as the window grows
+        std::string met = budget_us == 0 || lat.empty() ? std::string("-")
+                                                        : std::to_string((lat.size() - missed) * 100 / lat.size());
+
+        std::cout << std::setw(12) << (w >= 0 ? std::to_string(w) : std::string("server"))
+                  << std::setw(12) << clients
+                  << std::setw(12) << lat.size()
+                  << std::setw(12) << failed
+                  << std::setw(16) << std::fixed << std::setprecision(1) << (elapsed > 0.0 ? lat.size() / elapsed : 0.0)
+                  << std::setw(12) << percentile(lat, 0.50)
+                  << std::setw(12) << percentile(lat, 0.99)
+                  << std::setw(12) << (lat.empty() ? 0.0 : lat.back())
+                  << std::setw(12) << std::setprecision(2) << (lat.empty() ? 0.0 : static_cast<double>(batch_sum) / lat.size())
+                  << std::setw(14) << std::setprecision(1) << percentile(queued, 0.99)
+                  << std::setw(14) << missed
+                  << std::setw(12) << met
+                  << std::endl;
+    }
+
+    if (shutdown) {
+        proto::request req = {};
+        req.type = proto::msg_shutdown;
+        proto::write_full(fds[0], &req, sizeof(req));
+    }
+    for (int f : fds)
+        ::close(f);
+    return 0;
+}
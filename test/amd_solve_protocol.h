@@ -0,0 +1,126 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Wire protocol between amd_solve_server and amd_solve_client
+//
+// Messages are fixed size headers in host byte order (both ends run on the
+// same machine over a Unix-domain socket), followed for solve requests and
+// replies by n doubles.
+//
+//   server -> client on connect : reply{type = msg_hello, n = matrix order}
+//   client -> server            : request{msg_solve, budget_us, id, n} + rhs[n]
+//   server -> client            : reply{msg_solve, id, status, batch, ...} + x[n]
+//   client -> server            : request{msg_set_window, window_us}, acknowledged by a reply
+//   client -> server            : request{msg_shutdown}
+//
+#ifndef AMD_SOLVE_PROTOCOL_H
+#define AMD_SOLVE_PROTOCOL_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace amd_mumps {
+namespace solve_protocol {
+
+enum message_type : std::uint32_t {
+    msg_hello = 1,
+    msg_solve = 2,
+    msg_set_window = 3,
+    msg_shutdown = 4
+};
+
+struct request {
+    std::uint32_t type;
+    std::uint32_t budget_us;   // latency target of this request, 0 = none
+    std::uint64_t id;
+    std::uint64_t n;           // rhs entries following the header
+    std::uint64_t window_us;   // msg_set_window only
+};
+
+struct reply {
+    std::uint32_t type;
+    std::int32_t status;       // INFOG(1) of the JOB=3 call
+    std::uint64_t id;
+    std::uint64_t n;           // solution entries following the header
+    std::uint64_t batch;       // number of right-hand sides solved together
+    std::uint64_t queue_ns;    // time spent waiting for the batch to close
+    std::uint64_t solve_ns;    // time of the JOB=3 call
+};
+
+const char* const default_socket = "/tmp/amd_mumps_solve.sock";
+
+inline bool read_full(int fd, void* buf, std::size_t bytes)
+{
+    char* p = static_cast<char*>(buf);
+    while (bytes > 0) {
+        ssize_t r = ::recv(fd, p, bytes, 0);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return false;
+        p += r;
+        bytes -= static_cast<std::size_t>(r);
+    }
+    return true;
+}
+
+inline bool write_full(int fd, const void* buf, std::size_t bytes)
+{
+    const char* p = static_cast<const char*>(buf);
+    while (bytes > 0) {
+        // MSG_NOSIGNAL: a client that went away must not kill the server
+        ssize_t w = ::send(fd, p, bytes, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return false;
+        p += w;
+        bytes -= static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+inline bool make_address(const std::string& path, sockaddr_un& addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+} // namespace solve_protocol
+} // namespace amd_mumps
+
+#endif // AMD_SOLVE_PROTOCOL_H
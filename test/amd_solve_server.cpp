@@ -0,0 +1,596 @@
+/*
+    MIT License
+
+    Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+// =======================================================
+//
+// Purpose: Factor a matrix once with MUMPS and serve solves over a Unix-domain socket
+//
+// Requests arriving close together are coalesced into a single multi-RHS
+// JOB=3 call. A batch closes when it holds max_batch right-hand sides, when
+// the batching window since its oldest request expires, or earlier when a
+// request's own latency budget would otherwise be missed.
+//
+// Usage : mpirun -np X "executable" --mtx <matrix file> [--socket <path>] [--window_us <batching_window>]
+//                                   [--max_batch <max_rhs_per_solve>] [--budget_margin_us <slack_before_budget>]
+//                                   [--reply_timeout_ms <stalled_client_timeout>]
+//                                   [--wk_user <0|1>] [--spd <0|1>]
+//
+#ifdef MUMPS_MPI
+#include <mpi.h>
+#endif
+#include "dmumps_c.h"
+#include "amd_mumps_workspace.h"
+#include "amd_mumps_reader.h"
+#include "amd_solve_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define JOB_INIT -1
+#define JOB_END -2
+#define USE_COMM_WORLD -987654
+
+using get_time = std::chrono::steady_clock;
+namespace proto = amd_mumps::solve_protocol;
+
+/*
+    structure to store matrix data in co-ordinate storage format
+*/
+struct coo_matrix {
+    MUMPS_INT m = 0;
+    MUMPS_INT n = 0;
+    MUMPS_INT nnz = 0;
+    std::vector<MUMPS_INT> row_idxs;
+    std::vector<MUMPS_INT> col_idxs;
+    std::vector<double> values;
+    bool is_complex = false;
+    amd_mumps::matrix_symmetry symmetry = amd_mumps::matrix_symmetry::general;
+};
+
+static std::atomic<bool> stop_requested(false);
+
+extern "C" void on_signal(int)
+{
+    stop_requested = true;
+}
+
+/*
+    client connection, closed when the reader thread and every pending
+    request referencing it are gone
+*/
+struct connection {
+    explicit connection(int f) : fd(f) {}
+    ~connection() { ::close(fd); }
+
+    /*
+        Replies are written from the solver thread. The socket has a send
+        timeout, so a client that stops reading its replies fails the write
+        instead of stalling every other client; it is then dropped, since a
+        partially written reply leaves its stream unusable.
+    */
+    bool send_reply(const proto::reply& r, const double* x)
+    {
+        std::lock_guard<std::mutex> lock(write_mtx);
+        if (dropped)
+            return false;
+        // x = nullptr sends the header only (hello, acknowledgements, rejects)
+        if (proto::write_full(fd, &r, sizeof(r)) &&
+            (x == nullptr || proto::write_full(fd, x, r.n * sizeof(double))))
+            return true;
+        dropped = true;
+        ::shutdown(fd, SHUT_RDWR); // wakes the reader, which unregisters the client
+        return false;
+    }
+
+    int fd;
+    std::mutex write_mtx;
+    bool dropped = false;
+};
+
+/*
+    Live client connections. Reader threads are detached and unregister
+    themselves when their client leaves, so a long running server does not
+    accumulate finished threads or stale entries as clients reconnect.
+*/
+class connection_set {
+public:
+    void add(const std::shared_ptr<connection>& c)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        live_.insert(c);
+    }
+
+    void remove(const std::shared_ptr<connection>& c)
+    {
+        // notify under the lock: close_all() may return and destroy the set right after
+        std::lock_guard<std::mutex> lock(mtx_);
+        live_.erase(c);
+        cv_.notify_all();
+    }
+
+    /* unblock the readers still waiting on their clients and wait for all of them to exit */
+    void close_all()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (const auto& c : live_)
+            ::shutdown(c->fd, SHUT_RDWR);
+        cv_.wait(lock, [this] { return live_.empty(); });
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::set<std::shared_ptr<connection>> live_;
+};
+
+struct pending_solve {
+    std::shared_ptr<connection> conn;
+    std::uint64_t id;
+    get_time::time_point arrival;
+    get_time::time_point deadline;   // arrival + budget, max() when none
+    std::vector<double> rhs;
+};
+
+/*
+    queue of solve requests shared by the connection threads and the solver
+*/
+class request_queue {
+public:
+    void push(pending_solve&& p)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            q_.push_back(std::move(p));
+        }
+        cv_.notify_one();
+    }
+
+    /*
+        Block until a batch closes. Returns false once a stop is requested and
+        the queue is drained. lead, the expected time from closing a batch to
+        its last reply, is subtracted from the request budgets so the replies
+        reach the clients in time, not just the batch dispatched in time.
+    */
+    bool collect(std::vector<pending_solve>& batch, std::size_t max_batch,
+                 std::chrono::microseconds window, std::chrono::nanoseconds lead)
+    {
+        batch.clear();
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (q_.empty()) {
+            if (stop_requested)
+                return false;
+            cv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        for (;;) {
+            auto close_at = q_.front().arrival + window;
+            for (const auto& p : q_)
+                if (p.deadline != get_time::time_point::max())
+                    close_at = (std::min)(close_at, p.deadline - lead);
+            if (q_.size() >= max_batch || get_time::now() >= close_at || stop_requested)
+                break;
+            cv_.wait_until(lock, close_at);
+        }
+        std::size_t k = (std::min)(max_batch, q_.size());
+        for (std::size_t i = 0; i < k; i++) {
+            batch.push_back(std::move(q_.front()));
+            q_.pop_front();
+        }
+        return true;
+    }
+
+    void wake()
+    {
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<pending_solve> q_;
+};
+
+/*
+    Time from closing a batch to writing its last reply: copying the
+    right-hand sides, JOB=3 and the replies. Tracked like a TCP retransmission
+    timer, mean + 4 x mean deviation, so budgets hold for most batches rather
+    than for the average one.
+*/
+class service_estimate {
+public:
+    void update(std::chrono::nanoseconds sample)
+    {
+        if (mean_.count() == 0) {
+            mean_ = sample;
+            dev_ = sample / 2;
+            return;
+        }
+        std::chrono::nanoseconds err = sample > mean_ ? sample - mean_ : mean_ - sample;
+        dev_ = (3 * dev_ + err) / 4;
+        mean_ = (7 * mean_ + sample) / 8;
+    }
+
+    std::chrono::nanoseconds bound() const { return mean_ + 4 * dev_; }
+
+private:
+    std::chrono::nanoseconds mean_{0};
+    std::chrono::nanoseconds dev_{0};
+};
+
+/*
+    reads the requests of one client until it disconnects
+*/
+static void serve_connection(std::shared_ptr<connection> conn, MUMPS_INT n, request_queue& queue,
+                             std::atomic<std::uint64_t>& window_us)
+{
+    proto::reply hello = {};
+    hello.type = proto::msg_hello;
+    hello.n = static_cast<std::uint64_t>(n);
+    if (!conn->send_reply(hello, nullptr))
+        return;
+
+    proto::request req;
+    while (proto::read_full(conn->fd, &req, sizeof(req))) {
+        if (req.type == proto::msg_solve) {
+            if (req.n != static_cast<std::uint64_t>(n)) {
+                // the payload cannot be trusted, reject and drop the client
+                proto::reply r = {};
+                r.type = proto::msg_solve;
+                r.id = req.id;
+                r.status = -1;
+                conn->send_reply(r, nullptr);
+                break;
+            }
+            pending_solve p;
+            // stamped before the payload is read, closer to when the client started its clock
+            p.arrival = get_time::now();
+            p.conn = conn;
+            p.id = req.id;
+            p.rhs.resize(static_cast<std::size_t>(req.n));
+            if (!proto::read_full(conn->fd, p.rhs.data(), p.rhs.size() * sizeof(double)))
+                break;
+            p.deadline = req.budget_us ? p.arrival + std::chrono::microseconds(req.budget_us)
+                                       : get_time::time_point::max();
+            queue.push(std::move(p));
+        } else if (req.type == proto::msg_set_window) {
+            window_us = req.window_us;
+            proto::reply r = {};
+            r.type = proto::msg_set_window;
+            r.id = req.id;
+            conn->send_reply(r, nullptr);
+        } else if (req.type == proto::msg_shutdown) {
+            stop_requested = true;
+            queue.wake();
+            break;
+        } else {
+            break;
+        }
+    }
+}
+
+/*
+    usage function
+*/
+void print_help(char* server)
+{
+    std::cout << "\nUsage: " << server << " --mtx <matrix_file> [--socket <path>] [--window_us <us>] [--max_batch <k>] [--budget_margin_us <us>] [--reply_timeout_ms <ms>] [--wk_user <0|1>] [--spd <0|1>]\n";
+    std::cout << "\tmatrix_file: real input matrix in Matrix Market, Harwell-Boeing or Rutherford-Boeing format, plain or gzip/xz compressed\n";
+    std::cout << "\tpath: Unix-domain socket to listen on (default " << proto::default_socket << ")\n";
+    std::cout << "\twindow_us: batching window after the oldest pending request, in microseconds (default 100)\n";
+    std::cout << "\tk: maximum number of right-hand sides per JOB=3 call (default 64)\n";
+    std::cout << "\tbudget_margin_us: slack kept before a request budget for the client side transfer and wake-up (default 150)\n";
+    std::cout << "\treply_timeout_ms: a client whose replies make no progress for this long is dropped (default 100)\n";
+    std::cout << "\twk_user: 1 = keep the factors in a reusable WK_USER workspace (default 0)\n";
+    std::cout << "\tspd: 1 = factorize symmetric input as positive definite (SYM=1); default 0 = general symmetric (SYM=2)\n";
+}
+
+/*
+    =======main=========
+*/
+int main(int argc, char* argv[])
+{
+    int myid = 0, comm_size = 1;
+#ifdef MUMPS_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+    MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
+#endif
+
+    std::string matrix_name;
+    std::string socket_path = proto::default_socket;
+    std::atomic<std::uint64_t> window_us(100);
+    std::size_t max_batch = 64;
+    int reply_timeout_ms = 100;
+    std::chrono::microseconds budget_margin(150);
+    bool use_wk_user = false;
+    bool spd = false;
+
+    if (argc < 3 || argc % 2 == 0) {
+        print_help(argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "--mtx") == 0) {
+            matrix_name = argv[i+1];
+        } else if (strcmp(argv[i], "--socket") == 0) {
+            socket_path = argv[i+1];
+        } else if (strcmp(argv[i], "--window_us") == 0) {
+            window_us = static_cast<std::uint64_t>((std::max)(0, std::stoi(argv[i+1])));
+        } else if (strcmp(argv[i], "--max_batch") == 0) {
+            max_batch = static_cast<std::size_t>((std::max)(1, std::stoi(argv[i+1])));
+        } else if (strcmp(argv[i], "--budget_margin_us") == 0) {
+            budget_margin = std::chrono::microseconds((std::max)(0, std::stoi(argv[i+1])));
+        } else if (strcmp(argv[i], "--reply_timeout_ms") == 0) {
+            reply_timeout_ms = (std::max)(1, std::stoi(argv[i+1]));
+        } else if (strcmp(argv[i], "--wk_user") == 0) {
+            use_wk_user = std::stoi(argv[i+1]) > 0;
+        } else if (strcmp(argv[i], "--spd") == 0) {
+            spd = std::stoi(argv[i+1]) > 0;
+        } else {
+            std::cout << "Invalid option " << argv[i] << std::endl;
+            print_help(argv[0]);
+            return 1;
+        }
+    }
+
+    // mpiexec forwards SIGINT/SIGTERM to every rank: all of them must survive
+    // it and keep following the host broadcasts until the host stops
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    // -----------------------------------------
+    //   Read the matrix (host only)
+    // -----------------------------------------
+    coo_matrix matrix;
+    int ok = 1;
+    if (myid == 0) {
+        std::string err;
+        if (!amd_mumps::read_matrix(matrix_name, matrix, err)) {
+            std::cerr << err << std::endl;
+            ok = 0;
+        } else if (matrix.is_complex || matrix.m != matrix.n) {
+            std::cerr << "The solve server requires a square real matrix" << std::endl;
+            ok = 0;
+        }
+    }
+#ifdef MUMPS_MPI
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+    if (!ok) {
+#ifdef MUMPS_MPI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+    // ---------------------------------------------
+    //   Setup the MUMPS Solver
+    // ---------------------------------------------
+    DMUMPS_STRUC_C id;
+    // symmetric archive matrices are often indefinite, SPD is only assumed on request
+    int symVal = matrix.symmetry == amd_mumps::matrix_symmetry::general ? 0 : spd ? 1 : 2;
+#ifdef MUMPS_MPI
+    MPI_Bcast(&symVal, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+    id.job = JOB_INIT;
+    id.comm_fortran = USE_COMM_WORLD;
+    id.sym = symVal;
+    id.par = 1;
+    dmumps_c(&id);
+    if (id.infog[0] < 0) {
+        std::cout << "[PROCESS: " << myid << "] Mumps Init phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
+        return 1;
+    }
+
+    #define ICNTL(I) icntl[(I)-1] /* macro s.t. indices match documentation */
+    id.ICNTL(1) = 6; /*output stream for error messages: TO STD OUTPUT STREAM*/
+    id.ICNTL(2) = 0; /*output stream for diagnostic printing: SUPPRESSED*/
+    id.ICNTL(3) = 0; /*output stream for global information: SUPPRESSED, the server reports its own statistics*/
+    id.ICNTL(4) = 1; /* level of printing: ONLY ERROR MSGES PRINTED */
+    id.ICNTL(7) = 5; /* sequential ordering: METIS*/
+    id.ICNTL(10) = 0; /* no iterative refinement, keeps the per request latency bounded */
+    id.ICNTL(14) = 20; /* 20 % increase of the estimated working space */
+    id.ICNTL(22) = 0; /* In-core factorization and solution phases */
+    id.ICNTL(24) = 1; /* Null pivot row detection*/
+
+    // the matrix is only read on the host
+    MUMPS_INT n = matrix.n;
+#ifdef MUMPS_MPI
+    MPI_Bcast(&n, 1, sizeof(MUMPS_INT) == sizeof(long long) ? MPI_LONG_LONG : MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+    if (myid == 0) {
+        id.n = matrix.n;
+        id.nz = matrix.nnz;
+        id.irn = matrix.row_idxs.data();
+        id.jcn = matrix.col_idxs.data();
+        id.a = matrix.values.data();
+    }
+
+    // ---------------------------------------------
+    //   Analysis and factorization, once
+    // ---------------------------------------------
+    auto tf = get_time::now();
+    id.job = 1;
+    dmumps_c(&id);
+    if (id.infog[0] < 0) {
+        std::cout << "[PROCESS: " << myid << "] Mumps analysis phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
+        return 1;
+    }
+    // the factors live in the workspace, it must outlive every solve
+    amd_mumps::workspace<double> wk;
+    if (use_wk_user) {
+        if (!wk.reserve(amd_mumps::factorization_workspace_entries(id))) {
+            std::cout << "[PROCESS: " << myid << "] Failed to allocate WK_USER workspace\n";
+            return 1;
+        }
+        amd_mumps::attach_workspace(id, wk);
+    }
+    id.job = 2;
+    dmumps_c(&id);
+    if (id.infog[0] < 0) {
+        std::cout << "[PROCESS: " << myid << "] Mumps factorization phase failed. Error returned: \n\tINFOG(1)=" << id.infog[0] << "\n\tINFOG(2)=" << id.infog[1] << "\n";
+        return 1;
+    }
+    double factor_t = std::chrono::duration<double>(get_time::now() - tf).count();
+
+    // ---------------------------------------------
+    //   Listen (host only)
+    // ---------------------------------------------
+    request_queue queue;
+    int listen_fd = -1;
+    std::thread acceptor;
+    connection_set clients;
+    if (myid == 0) {
+        sockaddr_un addr;
+        listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 || !proto::make_address(socket_path, addr)) {
+            std::cerr << "Invalid socket " << socket_path << std::endl;
+            stop_requested = true;
+        } else {
+            ::unlink(socket_path.c_str());
+            if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listen_fd, 64) < 0) {
+                std::cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+                stop_requested = true;
+            }
+        }
+        if (!stop_requested) {
+            std::cout << "Factored " << matrix_name << " (n=" << n << ", nnz=" << matrix.nnz << ", mpi_ranks=" << comm_size
+                      << ") in " << factor_t << " s, serving on " << socket_path << std::endl;
+            acceptor = std::thread([&] {
+                while (!stop_requested) {
+                    pollfd pfd = {listen_fd, POLLIN, 0};
+                    if (::poll(&pfd, 1, 100) <= 0)
+                        continue;
+                    int fd = ::accept(listen_fd, nullptr, nullptr);
+                    if (fd < 0)
+                        continue;
+                    timeval tv = {reply_timeout_ms / 1000, (reply_timeout_ms % 1000) * 1000};
+                    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                    auto conn = std::make_shared<connection>(fd);
+                    clients.add(conn);
+                    std::thread([conn, n, &queue, &window_us, &clients] {
+                        serve_connection(conn, n, queue, window_us);
+                        clients.remove(conn);
+                    }).detach();
+                }
+                queue.wake();
+            });
+        }
+    }
+
+    // ---------------------------------------------
+    //   Solve loop: one multi-RHS JOB=3 per batch
+    // ---------------------------------------------
+    std::vector<pending_solve> batch;
+    std::vector<double> rhs;
+    service_estimate service;
+    std::uint64_t requests = 0, batches = 0;
+    double solve_total = 0.0;
+    for (;;) {
+        long long k = 0;
+        if (myid == 0 && queue.collect(batch, max_batch, std::chrono::microseconds(window_us.load()),
+                                       service.bound() + budget_margin))
+            k = static_cast<long long>(batch.size());
+        auto closed = get_time::now();
+#ifdef MUMPS_MPI
+        MPI_Bcast(&k, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+#endif
+        if (k == 0)
+            break;
+
+        auto dispatched = get_time::now();
+        if (myid == 0) {
+            // dense centralized right-hand sides, one column per request
+            rhs.resize(static_cast<std::size_t>(n) * k);
+            for (long long j = 0; j < k; j++)
+                std::copy(batch[j].rhs.begin(), batch[j].rhs.end(), rhs.begin() + j * n);
+            id.rhs = rhs.data();
+            id.nrhs = static_cast<MUMPS_INT>(k);
+            id.lrhs = n;
+        }
+        id.job = 3;
+        dmumps_c(&id);
+        auto solved = get_time::now();
+
+        if (myid == 0) {
+            std::chrono::nanoseconds solve_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(solved - dispatched);
+            for (long long j = 0; j < k; j++) {
+                proto::reply r = {};
+                r.type = proto::msg_solve;
+                r.status = static_cast<std::int32_t>(id.infog[0]);
+                r.id = batch[j].id;
+                r.n = static_cast<std::uint64_t>(n);
+                r.batch = static_cast<std::uint64_t>(k);
+                r.queue_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(closed - batch[j].arrival).count());
+                r.solve_ns = static_cast<std::uint64_t>(solve_ns.count());
+                batch[j].conn->send_reply(r, rhs.data() + j * n);
+            }
+            service.update(std::chrono::duration_cast<std::chrono::nanoseconds>(get_time::now() - closed));
+            requests += static_cast<std::uint64_t>(k);
+            batches++;
+            solve_total += std::chrono::duration<double>(solve_ns).count();
+            batch.clear();
+        }
+    }
+
+    // ---------------------------------------------
+    //   Shutdown
+    // ---------------------------------------------
+    if (myid == 0) {
+        if (acceptor.joinable())
+            acceptor.join();
+        clients.close_all();
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+            ::unlink(socket_path.c_str());
+        }
+        std::cout << "Served " << requests << " solves in " << batches << " batches, mean batch "
+                  << (batches ? static_cast<double>(requests) / batches : 0.0) << ", mean JOB=3 time "
+                  << (batches ? solve_total / batches : 0.0) << " s" << std::endl;
+    }
+
+    id.job = JOB_END;
+    dmumps_c(&id);
+
+#ifdef MUMPS_MPI
+    MPI_Finalize();
+#endif
+    return 0;
+}